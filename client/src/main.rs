@@ -109,80 +109,53 @@ fn find_nonce(challenge: &[u8; 32], signer: &Pubkey, difficulty: u64) -> [u8; 8]
     println!("  Signer:    {}", signer);
     // Nonce will be printed in the loop
 
-    let mut nonce_val = 0u64;
+    // Construct the 64-byte hash data: challenge (32) + signer[0..24] (24) + nonce (8).
+    // The nonce bytes are filled in per attempt by the search.
+    let mut hash_data = [0u8; 64];
+    hash_data[..32].copy_from_slice(challenge);
+    hash_data[32..56].copy_from_slice(&signer.to_bytes()[..24]);
+
+    // Log the first few hashes regardless of success
+    for nonce_val in 0..10u64 {
+        hash_data[56..64].copy_from_slice(&nonce_val.to_le_bytes());
+        let mut hash_be = verus::verus_hash_v2(&hash_data); // Little-Endian
+        hash_be.reverse();
+        println!("Nonce: {:<10} | Hash (BE): {:x?}", nonce_val, hash_be);
+    }
+
+    // Search in chunks so progress can be printed between them; each chunk
+    // is a single native scan that stops at the first hit.
+    const CHUNK: u64 = 1_000_000;
     let start_time = Instant::now(); // For calculating hash rate
-    let mut log_counter = 0; // Counter for logging initial hashes
+    let mut nonce_val = 0u64;
 
     loop {
-        let nonce_bytes = nonce_val.to_le_bytes();
-
-        // Construct the 64-byte hash data: challenge (32) + signer[0..24] (24) + nonce (8)
-        let mut hash_data = [0u8; 64];
-        hash_data[..32].copy_from_slice(challenge); // Pass challenge directly (it's already a reference)
-        hash_data[32..56].copy_from_slice(&signer.to_bytes()[..24]); // Use signer directly
-        hash_data[56..64].copy_from_slice(&nonce_bytes); // 8 bytes nonce
-
-        // Compute the hash (Little-Endian) using the 64-byte buffer
-        let hash_le = verus::verus_hash_v2(&hash_data);
-
-        // Convert hash to Big-Endian for comparison
-        let mut hash_be = [0u8; 32];
-        for i in 0..32 {
-            hash_be[i] = hash_le[31 - i];
-        }
-
-        // Log the first few hashes regardless of success
-        if log_counter < 10 {
-            // Log first 10 hashes
-            println!(
-                "Nonce: {:<10} | Hash (BE): {:x?}",
-                nonce_val,
-                hash_be // Show full BE hash
-            );
-            log_counter += 1;
-        }
-
-        // Verify hash against the big-endian target using standard comparison
-        // hash_be <= target_be
-        if hash_be <= target_be {
+        let end = nonce_val.saturating_add(CHUNK);
+        if let Some(found) = verus::search_v2(&hash_data, 56, nonce_val..end, &target_be).next() {
             let elapsed = start_time.elapsed();
             let rate = if elapsed.as_secs_f64() > 0.0 {
-                nonce_val as f64 / elapsed.as_secs_f64()
+                found as f64 / elapsed.as_secs_f64()
             } else {
                 0.0
             };
+            let nonce_bytes = found.to_le_bytes();
+            hash_data[56..64].copy_from_slice(&nonce_bytes);
+            let mut hash_be = verus::verus_hash_v2(&hash_data);
+            hash_be.reverse();
             println!(
                 "Found valid hash (BE): {:x?} <= Target (BE): {:x?}",
                 hash_be, // Show full BE hash
                 target_be
             );
-            println!("Checked {} nonces. Rate: {:.2} H/s", nonce_val + 1, rate);
+            println!("Checked {} nonces. Rate: {:.2} H/s", found + 1, rate);
             return nonce_bytes;
         }
+        nonce_val = end;
 
-        nonce_val += 1;
-
-        // Print progress occasionally without slowing down too much
-        // Also print current hash MSB vs target MSB comparison (using BE)
-        // Reduce frequency to avoid clutter
-        if nonce_val > 0 && nonce_val % 1_000_000 == 0 {
-            let elapsed = start_time.elapsed();
-            if elapsed.as_secs() > 0 {
-                let rate = nonce_val as f64 / elapsed.as_secs_f64();
-                // Show most significant byte (index 0) comparison from BE arrays
-                println!(
-                    "...checked {} nonces. Rate: {:.2} H/s. Hash MSB: {:02x} vs Target MSB: {:02x}",
-                    nonce_val,
-                    rate,
-                    hash_be[0],   // Most significant byte of BE hash
-                    target_be[0]  // Most significant byte of BE target
-                );
-            }
+        let elapsed = start_time.elapsed();
+        if elapsed.as_secs() > 0 {
+            let rate = nonce_val as f64 / elapsed.as_secs_f64();
+            println!("...checked {} nonces. Rate: {:.2} H/s", nonce_val, rate);
         }
-        // Add a safety break for testing/debugging if needed,
-        // but in a real client, this might run indefinitely.
-        // if nonce_val > 1_000_000 { // Example safety break for quick tests
-        //     panic!("Nonce search safety break reached");
-        // }
     }
 }
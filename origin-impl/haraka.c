@@ -25,6 +25,7 @@ Optimized Implementations for Haraka256 and Haraka512
 */
 
 #include <stdio.h>
+#include <cpuid.h>
 #include "haraka.h"
 
 u128 rc[40];
@@ -663,3 +664,155 @@ void haraka512_8x(unsigned char *out, const unsigned char *in) {
   // TRUNCSTORE(out + 192, s[6][0], s[6][1], s[6][2], s[6][3]);
   // TRUNCSTORE(out + 224, s[7][0], s[7][1], s[7][2], s[7][3]);
 }
+
+void haraka512_zero_4x(unsigned char *out, const unsigned char *in) {
+  u128 s[4][4], tmp;
+
+  s[0][0] = LOAD(in);
+  s[0][1] = LOAD(in + 16);
+  s[0][2] = LOAD(in + 32);
+  s[0][3] = LOAD(in + 48);
+  s[1][0] = LOAD(in + 64);
+  s[1][1] = LOAD(in + 80);
+  s[1][2] = LOAD(in + 96);
+  s[1][3] = LOAD(in + 112);
+  s[2][0] = LOAD(in + 128);
+  s[2][1] = LOAD(in + 144);
+  s[2][2] = LOAD(in + 160);
+  s[2][3] = LOAD(in + 176);
+  s[3][0] = LOAD(in + 192);
+  s[3][1] = LOAD(in + 208);
+  s[3][2] = LOAD(in + 224);
+  s[3][3] = LOAD(in + 240);
+
+  AES4_zero_4x(s[0], s[1], s[2], s[3], 0);
+  MIX4(s[0][0], s[0][1], s[0][2], s[0][3]);
+  MIX4(s[1][0], s[1][1], s[1][2], s[1][3]);
+  MIX4(s[2][0], s[2][1], s[2][2], s[2][3]);
+  MIX4(s[3][0], s[3][1], s[3][2], s[3][3]);
+
+  AES4_zero_4x(s[0], s[1], s[2], s[3], 8);
+  MIX4(s[0][0], s[0][1], s[0][2], s[0][3]);
+  MIX4(s[1][0], s[1][1], s[1][2], s[1][3]);
+  MIX4(s[2][0], s[2][1], s[2][2], s[2][3]);
+  MIX4(s[3][0], s[3][1], s[3][2], s[3][3]);
+
+  AES4_zero_4x(s[0], s[1], s[2], s[3], 16);
+  MIX4(s[0][0], s[0][1], s[0][2], s[0][3]);
+  MIX4(s[1][0], s[1][1], s[1][2], s[1][3]);
+  MIX4(s[2][0], s[2][1], s[2][2], s[2][3]);
+  MIX4(s[3][0], s[3][1], s[3][2], s[3][3]);
+
+  AES4_zero_4x(s[0], s[1], s[2], s[3], 24);
+  MIX4(s[0][0], s[0][1], s[0][2], s[0][3]);
+  MIX4(s[1][0], s[1][1], s[1][2], s[1][3]);
+  MIX4(s[2][0], s[2][1], s[2][2], s[2][3]);
+  MIX4(s[3][0], s[3][1], s[3][2], s[3][3]);
+
+  AES4_zero_4x(s[0], s[1], s[2], s[3], 32);
+  MIX4(s[0][0], s[0][1], s[0][2], s[0][3]);
+  MIX4(s[1][0], s[1][1], s[1][2], s[1][3]);
+  MIX4(s[2][0], s[2][1], s[2][2], s[2][3]);
+  MIX4(s[3][0], s[3][1], s[3][2], s[3][3]);
+
+
+  s[0][0] = _mm_xor_si128(s[0][0], LOAD(in));
+  s[0][1] = _mm_xor_si128(s[0][1], LOAD(in + 16));
+  s[0][2] = _mm_xor_si128(s[0][2], LOAD(in + 32));
+  s[0][3] = _mm_xor_si128(s[0][3], LOAD(in + 48));
+  s[1][0] = _mm_xor_si128(s[1][0], LOAD(in + 64));
+  s[1][1] = _mm_xor_si128(s[1][1], LOAD(in + 80));
+  s[1][2] = _mm_xor_si128(s[1][2], LOAD(in + 96));
+  s[1][3] = _mm_xor_si128(s[1][3], LOAD(in + 112));
+  s[2][0] = _mm_xor_si128(s[2][0], LOAD(in + 128));
+  s[2][1] = _mm_xor_si128(s[2][1], LOAD(in + 144));
+  s[2][2] = _mm_xor_si128(s[2][2], LOAD(in + 160));
+  s[2][3] = _mm_xor_si128(s[2][3], LOAD(in + 176));
+  s[3][0] = _mm_xor_si128(s[3][0], LOAD(in + 192));
+  s[3][1] = _mm_xor_si128(s[3][1], LOAD(in + 208));
+  s[3][2] = _mm_xor_si128(s[3][2], LOAD(in + 224));
+  s[3][3] = _mm_xor_si128(s[3][3], LOAD(in + 240));
+
+  TRUNCSTORE(out, s[0][0], s[0][1], s[0][2], s[0][3]);
+  TRUNCSTORE(out + 32, s[1][0], s[1][1], s[1][2], s[1][3]);
+  TRUNCSTORE(out + 64, s[2][0], s[2][1], s[2][2], s[2][3]);
+  TRUNCSTORE(out + 96, s[3][0], s[3][1], s[3][2], s[3][3]);
+}
+
+void haraka512_zero_8x(unsigned char *out, const unsigned char *in) {
+  haraka512_zero_4x(out, in);
+  haraka512_zero_4x(out + 128, in + 256);
+}
+
+#ifndef bit_VAES
+#define bit_VAES (1 << 9)
+#endif
+
+static int vaes_level = -1;
+
+int haraka_vaes_level() {
+  unsigned int eax, ebx, ecx, edx, xcr0, xcr0_hi;
+
+  if (vaes_level >= 0)
+    return vaes_level;
+  vaes_level = 0;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) ||
+      (ecx & (bit_OSXSAVE | bit_AVX)) != (bit_OSXSAVE | bit_AVX) ||
+      __get_cpuid_max(0, 0) < 7)
+    return vaes_level;
+
+  __asm__ ("xgetbv" : "=a"(xcr0), "=d"(xcr0_hi) : "c"(0));
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  if (!(ecx & bit_VAES) || !(ebx & bit_AVX2) || (xcr0 & 0x06) != 0x06)
+    return vaes_level;
+  vaes_level = 1;
+  // zmm state: opmask, upper 256 bits of zmm0-15, zmm16-31
+  if ((ebx & bit_AVX512F) && (xcr0 & 0xe0) == 0xe0)
+    vaes_level = 2;
+  return vaes_level;
+}
+
+void haraka256_16x(unsigned char *out, const unsigned char *in) {
+  switch (haraka_vaes_level()) {
+  case 2:
+    haraka256_vaes_16x(out, in);
+    break;
+  case 1:
+    haraka256_vaes_8x(out, in);
+    haraka256_vaes_8x(out + 256, in + 256);
+    break;
+  default:
+    haraka256_8x(out, in);
+    haraka256_8x(out + 256, in + 256);
+  }
+}
+
+void haraka512_16x(unsigned char *out, const unsigned char *in) {
+  switch (haraka_vaes_level()) {
+  case 2:
+    haraka512_vaes_16x(out, in);
+    break;
+  case 1:
+    haraka512_vaes_8x(out, in);
+    haraka512_vaes_8x(out + 256, in + 512);
+    break;
+  default:
+    haraka512_8x(out, in);
+    haraka512_8x(out + 256, in + 512);
+  }
+}
+
+void haraka512_zero_16x(unsigned char *out, const unsigned char *in) {
+  switch (haraka_vaes_level()) {
+  case 2:
+    haraka512_zero_vaes_16x(out, in);
+    break;
+  case 1:
+    haraka512_zero_vaes_8x(out, in);
+    haraka512_zero_vaes_8x(out + 256, in + 512);
+    break;
+  default:
+    haraka512_zero_8x(out, in);
+    haraka512_zero_8x(out + 256, in + 512);
+  }
+}
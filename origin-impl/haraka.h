@@ -38,6 +38,7 @@ typedef unsigned long u64;
 typedef __m128i u128;
 
 extern u128 rc[40];
+extern u128 rc0[40];
 
 #define LOAD(src) _mm_load_si128((u128 *)(src))
 #define STORE(dest,src) _mm_storeu_si128((u128 *)(dest),src)
@@ -88,6 +89,12 @@ extern u128 rc[40];
   AES4_4x(s0, s1, s2, s3, rci); \
   AES4_4x(s4, s5, s6, s7, rci);
 
+#define AES4_zero_4x(s0, s1, s2, s3, rci) \
+  AES4_zero(s0[0], s0[1], s0[2], s0[3], rci); \
+  AES4_zero(s1[0], s1[1], s1[2], s1[3], rci); \
+  AES4_zero(s2[0], s2[1], s2[2], s2[3], rci); \
+  AES4_zero(s3[0], s3[1], s3[2], s3[3], rci);
+
 #define MIX2(s0, s1) \
   tmp = _mm_unpacklo_epi32(s0, s1); \
   s1 = _mm_unpackhi_epi32(s0, s1); \
@@ -124,5 +131,25 @@ void haraka512_zero(unsigned char *out, const unsigned char *in);
 void haraka512_keyed(unsigned char *out, const unsigned char *in, const u128 *rc);
 void haraka512_4x(unsigned char *out, const unsigned char *in);
 void haraka512_8x(unsigned char *out, const unsigned char *in);
+void haraka512_zero_4x(unsigned char *out, const unsigned char *in);
+void haraka512_zero_8x(unsigned char *out, const unsigned char *in);
+
+/* VAES kernels (haraka_vaes.c): 8 states on 256-bit vectors (VAES + AVX2)
+   or 16 states on 512-bit vectors (VAES + AVX-512F).  Callers must check
+   haraka_vaes_level() first. */
+void haraka256_vaes_8x(unsigned char *out, const unsigned char *in);
+void haraka512_vaes_8x(unsigned char *out, const unsigned char *in);
+void haraka512_zero_vaes_8x(unsigned char *out, const unsigned char *in);
+void haraka256_vaes_16x(unsigned char *out, const unsigned char *in);
+void haraka512_vaes_16x(unsigned char *out, const unsigned char *in);
+void haraka512_zero_vaes_16x(unsigned char *out, const unsigned char *in);
+
+/* 0: no VAES, 1: VAES on 256-bit vectors, 2: VAES on 512-bit vectors */
+int haraka_vaes_level();
+
+/* 16 states; the widest VAES kernel the CPU runs, else two 8x calls */
+void haraka256_16x(unsigned char *out, const unsigned char *in);
+void haraka512_16x(unsigned char *out, const unsigned char *in);
+void haraka512_zero_16x(unsigned char *out, const unsigned char *in);
 
 #endif
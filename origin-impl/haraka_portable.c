@@ -399,6 +399,43 @@ void haraka256_port(unsigned char *out, const unsigned char *in)
     }
 }
 
+void haraka256_port_4x(unsigned char *out, const unsigned char *in)
+{
+    int i, j, k;
+
+    unsigned char s[4][32], tmp[16];
+
+    memcpy(s, in, 4 * 32);
+
+    for (i = 0; i < 5; ++i) {
+        // aes round(s), the same key for all four states
+        for (j = 0; j < 2; ++j) {
+            for (k = 0; k < 4; ++k) {
+                aesenc(s[k], rc[2*2*i + 2*j]);
+                aesenc(s[k] + 16, rc[2*2*i + 2*j + 1]);
+            }
+        }
+
+        // mixing
+        for (k = 0; k < 4; ++k) {
+            unpacklo32(tmp, s[k], s[k] + 16);
+            unpackhi32(s[k] + 16, s[k], s[k] + 16);
+            memcpy(s[k], tmp, 16);
+        }
+    }
+
+    /* Feed-forward */
+    for (i = 0; i < 4 * 32; i++) {
+        out[i] = in[i] ^ s[i / 32][i % 32];
+    }
+}
+
+void haraka256_port_8x(unsigned char *out, const unsigned char *in)
+{
+    haraka256_port_4x(out, in);
+    haraka256_port_4x(out + 128, in + 128);
+}
+
 void haraka256_sk(unsigned char *out, const unsigned char *in)
 {
     int i, j;
@@ -78,6 +78,11 @@ void haraka512_port_zero(unsigned char *out, const unsigned char *in);
 /* Implementation of Haraka-256 */
 void haraka256_port(unsigned char *out, const unsigned char *in);
 
+/* Haraka-256 of 4 (8) independent 32-byte inputs, packed in order in in
+   and out, as haraka256_4x (haraka256_8x) */
+void haraka256_port_4x(unsigned char *out, const unsigned char *in);
+void haraka256_port_8x(unsigned char *out, const unsigned char *in);
+
 /* Implementation of Haraka-256 using sk.seed constants */
 void haraka256_sk(unsigned char *out, const unsigned char *in);
 
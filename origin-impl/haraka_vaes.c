@@ -0,0 +1,268 @@
+/*
+VAES kernels for Haraka256 and Haraka512
+
+The 128-bit AES-NI kernels of haraka.c spread across 256-bit (VAES + AVX2,
+8 states) and 512-bit (VAES + AVX-512F, 16 states) vectors.  Vector g*4+b
+holds block b of states 2g, 2g+1 (or 4g..4g+3), one 128-bit lane per
+state, so AESENC and the MIX2/MIX4 unpacks, which all work lane by lane,
+run unchanged on every state at once.
+
+This file is built with -mvaes -mavx2 -mavx512f; only call it when the
+CPU reports those features (haraka256_16x and friends in haraka.c check).
+Output is identical to haraka256 / haraka512 / haraka512_zero.
+*/
+#include "haraka.h"
+
+#if defined(__GNUC__) && !defined(__clang__)
+#define UNROLL _Pragma("GCC unroll 16")
+#else
+#define UNROLL _Pragma("unroll")
+#endif
+
+/* ---------------- 256-bit: two states per vector ---------------- */
+
+typedef __m256i u256;
+
+/* [a.lane sel0, b.lane sel1] */
+#define LANES256(a, b, imm) _mm256_permute2x128_si256(a, b, imm)
+
+#define AESENC256(s, k) s = _mm256_aesenc_epi128(s, _mm256_broadcastsi128_si256(k))
+
+#define MIX2_256(s0, s1) \
+  tmp = _mm256_unpacklo_epi32(s0, s1); \
+  s1 = _mm256_unpackhi_epi32(s0, s1); \
+  s0 = tmp;
+
+#define MIX4_256(s0, s1, s2, s3) \
+  tmp  = _mm256_unpacklo_epi32(s0, s1); \
+  s0 = _mm256_unpackhi_epi32(s0, s1); \
+  s1 = _mm256_unpacklo_epi32(s2, s3); \
+  s2 = _mm256_unpackhi_epi32(s2, s3); \
+  s3 = _mm256_unpacklo_epi32(s0, s2); \
+  s0 = _mm256_unpackhi_epi32(s0, s2); \
+  s2 = _mm256_unpackhi_epi32(s1, tmp); \
+  s1 = _mm256_unpacklo_epi32(s1, tmp);
+
+/* blocks 0..3 of the state pair at in (64 bytes each) */
+static inline void load512_x2(u256 s[4], const unsigned char *in) {
+  const u256 a0 = _mm256_loadu_si256((const u256 *)in);
+  const u256 a1 = _mm256_loadu_si256((const u256 *)(in + 32));
+  const u256 b0 = _mm256_loadu_si256((const u256 *)(in + 64));
+  const u256 b1 = _mm256_loadu_si256((const u256 *)(in + 96));
+
+  s[0] = LANES256(a0, b0, 0x20);
+  s[1] = LANES256(a0, b0, 0x31);
+  s[2] = LANES256(a1, b1, 0x20);
+  s[3] = LANES256(a1, b1, 0x31);
+}
+
+static inline void haraka512_x8_256(unsigned char *out, const unsigned char *in,
+                                    const u128 *k) {
+  u256 s[4][4], t[4], tmp;
+  int g, r;
+
+  UNROLL
+  for (g = 0; g < 4; ++g)
+    load512_x2(s[g], in + 128 * g);
+
+  UNROLL
+  for (r = 0; r < NUMROUNDS; ++r) {
+    UNROLL
+    for (g = 0; g < 4; ++g) {
+      AESENC256(s[g][0], k[8 * r]);
+      AESENC256(s[g][1], k[8 * r + 1]);
+      AESENC256(s[g][2], k[8 * r + 2]);
+      AESENC256(s[g][3], k[8 * r + 3]);
+      AESENC256(s[g][0], k[8 * r + 4]);
+      AESENC256(s[g][1], k[8 * r + 5]);
+      AESENC256(s[g][2], k[8 * r + 6]);
+      AESENC256(s[g][3], k[8 * r + 7]);
+      MIX4_256(s[g][0], s[g][1], s[g][2], s[g][3]);
+    }
+  }
+
+  /* feed-forward, then TRUNCSTORE: hi64(s0) hi64(s1) lo64(s2) lo64(s3) */
+  UNROLL
+  for (g = 0; g < 4; ++g) {
+    load512_x2(t, in + 128 * g);
+    const u256 hi = _mm256_unpackhi_epi64(_mm256_xor_si256(s[g][0], t[0]),
+                                          _mm256_xor_si256(s[g][1], t[1]));
+    const u256 lo = _mm256_unpacklo_epi64(_mm256_xor_si256(s[g][2], t[2]),
+                                          _mm256_xor_si256(s[g][3], t[3]));
+    _mm256_storeu_si256((u256 *)(out + 64 * g), LANES256(hi, lo, 0x20));
+    _mm256_storeu_si256((u256 *)(out + 64 * g + 32), LANES256(hi, lo, 0x31));
+  }
+}
+
+void haraka512_vaes_8x(unsigned char *out, const unsigned char *in) {
+  haraka512_x8_256(out, in, rc);
+}
+
+void haraka512_zero_vaes_8x(unsigned char *out, const unsigned char *in) {
+  haraka512_x8_256(out, in, rc0);
+}
+
+void haraka256_vaes_8x(unsigned char *out, const unsigned char *in) {
+  u256 s[4][2], tmp;
+  int g, r;
+
+  UNROLL
+  for (g = 0; g < 4; ++g) {
+    const u256 a = _mm256_loadu_si256((const u256 *)(in + 64 * g));
+    const u256 b = _mm256_loadu_si256((const u256 *)(in + 64 * g + 32));
+    s[g][0] = LANES256(a, b, 0x20);
+    s[g][1] = LANES256(a, b, 0x31);
+  }
+
+  UNROLL
+  for (r = 0; r < NUMROUNDS; ++r) {
+    UNROLL
+    for (g = 0; g < 4; ++g) {
+      AESENC256(s[g][0], rc[4 * r]);
+      AESENC256(s[g][1], rc[4 * r + 1]);
+      AESENC256(s[g][0], rc[4 * r + 2]);
+      AESENC256(s[g][1], rc[4 * r + 3]);
+      MIX2_256(s[g][0], s[g][1]);
+    }
+  }
+
+  UNROLL
+  for (g = 0; g < 4; ++g) {
+    const u256 a = _mm256_loadu_si256((const u256 *)(in + 64 * g));
+    const u256 b = _mm256_loadu_si256((const u256 *)(in + 64 * g + 32));
+    s[g][0] = _mm256_xor_si256(s[g][0], LANES256(a, b, 0x20));
+    s[g][1] = _mm256_xor_si256(s[g][1], LANES256(a, b, 0x31));
+    _mm256_storeu_si256((u256 *)(out + 64 * g), LANES256(s[g][0], s[g][1], 0x20));
+    _mm256_storeu_si256((u256 *)(out + 64 * g + 32), LANES256(s[g][0], s[g][1], 0x31));
+  }
+}
+
+/* ---------------- 512-bit: four states per vector ---------------- */
+
+typedef __m512i u512;
+
+#define AESENC512(s, k) s = _mm512_aesenc_epi128(s, _mm512_broadcast_i32x4(k))
+
+#define MIX2_512(s0, s1) \
+  tmp = _mm512_unpacklo_epi32(s0, s1); \
+  s1 = _mm512_unpackhi_epi32(s0, s1); \
+  s0 = tmp;
+
+#define MIX4_512(s0, s1, s2, s3) \
+  tmp  = _mm512_unpacklo_epi32(s0, s1); \
+  s0 = _mm512_unpackhi_epi32(s0, s1); \
+  s1 = _mm512_unpacklo_epi32(s2, s3); \
+  s2 = _mm512_unpackhi_epi32(s2, s3); \
+  s3 = _mm512_unpacklo_epi32(s0, s2); \
+  s0 = _mm512_unpackhi_epi32(s0, s2); \
+  s2 = _mm512_unpackhi_epi32(s1, tmp); \
+  s1 = _mm512_unpacklo_epi32(s1, tmp);
+
+/* 4x4 transpose of 128-bit lanes: x[i] lane j <- v[j] lane i */
+static inline void transpose4_512(u512 x[4], u512 a, u512 b, u512 c, u512 d) {
+  const u512 t0 = _mm512_shuffle_i64x2(a, b, _MM_SHUFFLE(1, 0, 1, 0));
+  const u512 t1 = _mm512_shuffle_i64x2(a, b, _MM_SHUFFLE(3, 2, 3, 2));
+  const u512 t2 = _mm512_shuffle_i64x2(c, d, _MM_SHUFFLE(1, 0, 1, 0));
+  const u512 t3 = _mm512_shuffle_i64x2(c, d, _MM_SHUFFLE(3, 2, 3, 2));
+
+  x[0] = _mm512_shuffle_i64x2(t0, t2, _MM_SHUFFLE(2, 0, 2, 0));
+  x[1] = _mm512_shuffle_i64x2(t0, t2, _MM_SHUFFLE(3, 1, 3, 1));
+  x[2] = _mm512_shuffle_i64x2(t1, t3, _MM_SHUFFLE(2, 0, 2, 0));
+  x[3] = _mm512_shuffle_i64x2(t1, t3, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+/* blocks 0..3 of the four states at in (64 bytes each) */
+static inline void load512_x4(u512 s[4], const unsigned char *in) {
+  transpose4_512(s, _mm512_loadu_si512(in), _mm512_loadu_si512(in + 64),
+                 _mm512_loadu_si512(in + 128), _mm512_loadu_si512(in + 192));
+}
+
+/* 32-byte results [a.lane j, b.lane j] for j = 0..3 */
+static inline void store_pairs_512(unsigned char *out, u512 a, u512 b) {
+  const u512 i01 = _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11);
+  const u512 i23 = _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15);
+
+  _mm512_storeu_si512(out, _mm512_permutex2var_epi64(a, i01, b));
+  _mm512_storeu_si512(out + 64, _mm512_permutex2var_epi64(a, i23, b));
+}
+
+static inline void haraka512_x16_512(unsigned char *out, const unsigned char *in,
+                                     const u128 *k) {
+  u512 s[4][4], t[4], tmp;
+  int g, r;
+
+  UNROLL
+  for (g = 0; g < 4; ++g)
+    load512_x4(s[g], in + 256 * g);
+
+  UNROLL
+  for (r = 0; r < NUMROUNDS; ++r) {
+    UNROLL
+    for (g = 0; g < 4; ++g) {
+      AESENC512(s[g][0], k[8 * r]);
+      AESENC512(s[g][1], k[8 * r + 1]);
+      AESENC512(s[g][2], k[8 * r + 2]);
+      AESENC512(s[g][3], k[8 * r + 3]);
+      AESENC512(s[g][0], k[8 * r + 4]);
+      AESENC512(s[g][1], k[8 * r + 5]);
+      AESENC512(s[g][2], k[8 * r + 6]);
+      AESENC512(s[g][3], k[8 * r + 7]);
+      MIX4_512(s[g][0], s[g][1], s[g][2], s[g][3]);
+    }
+  }
+
+  UNROLL
+  for (g = 0; g < 4; ++g) {
+    load512_x4(t, in + 256 * g);
+    store_pairs_512(out + 128 * g,
+                    _mm512_unpackhi_epi64(_mm512_xor_si512(s[g][0], t[0]),
+                                          _mm512_xor_si512(s[g][1], t[1])),
+                    _mm512_unpacklo_epi64(_mm512_xor_si512(s[g][2], t[2]),
+                                          _mm512_xor_si512(s[g][3], t[3])));
+  }
+}
+
+void haraka512_vaes_16x(unsigned char *out, const unsigned char *in) {
+  haraka512_x16_512(out, in, rc);
+}
+
+void haraka512_zero_vaes_16x(unsigned char *out, const unsigned char *in) {
+  haraka512_x16_512(out, in, rc0);
+}
+
+/* two 32-byte states per 64-byte load: lanes a0 a1 b0 b1 */
+static inline void load256_x4(u512 s[2], const unsigned char *in) {
+  const u512 ab = _mm512_loadu_si512(in);
+  const u512 cd = _mm512_loadu_si512(in + 64);
+
+  s[0] = _mm512_shuffle_i64x2(ab, cd, _MM_SHUFFLE(2, 0, 2, 0));
+  s[1] = _mm512_shuffle_i64x2(ab, cd, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+void haraka256_vaes_16x(unsigned char *out, const unsigned char *in) {
+  u512 s[4][2], t[2], tmp;
+  int g, r;
+
+  UNROLL
+  for (g = 0; g < 4; ++g)
+    load256_x4(s[g], in + 128 * g);
+
+  UNROLL
+  for (r = 0; r < NUMROUNDS; ++r) {
+    UNROLL
+    for (g = 0; g < 4; ++g) {
+      AESENC512(s[g][0], rc[4 * r]);
+      AESENC512(s[g][1], rc[4 * r + 1]);
+      AESENC512(s[g][0], rc[4 * r + 2]);
+      AESENC512(s[g][1], rc[4 * r + 3]);
+      MIX2_512(s[g][0], s[g][1]);
+    }
+  }
+
+  UNROLL
+  for (g = 0; g < 4; ++g) {
+    load256_x4(t, in + 128 * g);
+    store_pairs_512(out + 128 * g, _mm512_xor_si512(s[g][0], t[0]),
+                    _mm512_xor_si512(s[g][1], t[1]));
+  }
+}
@@ -40,6 +40,7 @@ int __cpuverusoptimized = 0x80;
 
 thread_local thread_specific_ptr verusclhasher_key;
 thread_local thread_specific_ptr verusclhasher_descr;
+thread_local thread_specific_ptr verusclhasher_keys;
 
 #if defined(__APPLE__) || defined(_WIN32)
 // attempt to workaround horrible mingw/gcc destructor bug on Windows and Mac, which passes garbage in the this pointer
@@ -54,6 +55,10 @@ thread_specific_ptr::~thread_specific_ptr() {
     {
         verusclhasher_descr.reset();
     }
+    if (verusclhasher_keys.ptr)
+    {
+        verusclhasher_keys.reset();
+    }
 }
 #endif // defined(__APPLE__) || defined(_WIN32)
 #if defined(__arm__)  || defined(__aarch64__) //intrinsics not defined in SSE2NEON.h
@@ -1072,3 +1077,39 @@ void *alloc_aligned_buffer(uint64_t bufSize)
         return answer;
     }
 }
+
+uint64_t VerusHashContext::SpaceSize(uint32_t keysize)
+{
+    keysize = (keysize >> 5) << 5;
+    return ((uint64_t)keysize << 1) + (verusclhasher::keysstride(keysize) << 3);
+}
+
+VerusHashContext::VerusHashContext(uint32_t keysize) : keys(NULL), descr(), owned(true)
+{
+    descr.keySizeInBytes = (keysize >> 5) << 5;
+    key = (unsigned char *)alloc_aligned_buffer(SpaceSize(keysize));
+    if (key)
+    {
+        keys = key + ((uint64_t)descr.keySizeInBytes << 1);
+    }
+}
+
+VerusHashContext::VerusHashContext(unsigned char *space, uint32_t keysize) : key(space), keys(NULL), descr(), owned(false)
+{
+    descr.keySizeInBytes = (keysize >> 5) << 5;
+    if (key)
+    {
+        keys = key + ((uint64_t)descr.keySizeInBytes << 1);
+    }
+}
+
+// the compile-time specialized Finalize2b, here so that the CLHASH above inlines into it
+template void CVerusHashV2::Finalize2bT<SOLUTION_VERUSHHASH_V2, VERUSCLHASH_NATIVE>(unsigned char hash[32]);
+template void CVerusHashV2::Finalize2bT<SOLUTION_VERUSHHASH_V2_1, VERUSCLHASH_NATIVE>(unsigned char hash[32]);
+template void CVerusHashV2::Finalize2bT<SOLUTION_VERUSHHASH_V2_2, VERUSCLHASH_NATIVE>(unsigned char hash[32]);
+
+// the multi-key Finalize2b, instantiated once for the 4 and 8 wide Haraka-256 of GenNewCLKeys
+template void CVerusHashV2::GenNewCLKeys<4>(unsigned char *const keys[4], const unsigned char *const seeds[4], int size);
+template void CVerusHashV2::GenNewCLKeys<8>(unsigned char *const keys[8], const unsigned char *const seeds[8], int size);
+template void CVerusHashV2::Finalize2bN<4>(CVerusHashV2 *const hashers[4], unsigned char *hashes);
+template void CVerusHashV2::Finalize2bN<8>(CVerusHashV2 *const hashers[8], unsigned char *hashes);
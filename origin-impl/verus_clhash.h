@@ -52,10 +52,14 @@ enum {
 	SOLUTION_VERUSHHASH_V2_2 = 4 
 };
 
+// Value-initialise it (descr(), new verusclhash_descr()): keyValid starts
+// false, so the first GenNewCLKey derives the key even for the all-zero
+// seed of a message under 32 bytes.
 struct verusclhash_descr
 {
     uint256 seed;
     uint32_t keySizeInBytes;
+    bool keyValid;              // key holds the key of seed
 };
 
 struct thread_specific_ptr {
@@ -81,8 +85,31 @@ struct thread_specific_ptr {
 #endif
 };
 
+// key space one worker hashes with, in place of the thread's verusclhasher_key, _descr and
+// _keys below: the key, its refresh copy and the move scratch (2 * keySizeInBytes), then the
+// 8 keys of CVerusHashV2::Finalize2bN, all in one alloc_aligned_buffer block allocated up
+// front. every solution version uses the same key size, so one context serves them all.
+// key is NULL if the allocation failed. the second constructor lays the same out in space
+// the caller owns (SpaceSize bytes, 32-byte aligned), e.g. a VerusKeyArena region
+struct VerusHashContext
+{
+    unsigned char *key;
+    unsigned char *keys;
+    verusclhash_descr descr;
+    bool owned;
+
+    VerusHashContext(uint32_t keysize=VERUSKEYSIZE);
+    VerusHashContext(unsigned char *space, uint32_t keysize=VERUSKEYSIZE);
+    ~VerusHashContext() { if (owned) std::free(key); }
+    static uint64_t SpaceSize(uint32_t keysize=VERUSKEYSIZE);
+    VerusHashContext(const VerusHashContext &) = delete;
+    VerusHashContext &operator=(const VerusHashContext &) = delete;
+};
+
 extern thread_local thread_specific_ptr verusclhasher_key;
 extern thread_local thread_specific_ptr verusclhasher_descr;
+// up to 8 keys with their move scratch, for CVerusHashV2::Finalize2bN
+extern thread_local thread_specific_ptr verusclhasher_keys;
 
 extern int __cpuverusoptimized;
 
@@ -145,6 +172,8 @@ struct verusclhasher {
     uint64_t (*verusclhashfunction)(void * random, const unsigned char buf[64], uint64_t keyMask, __m128i **pMoveScratch);
     __m128i (*verusinternalclhashfunction)(__m128i *randomsource, const __m128i buf[4], uint64_t keyMask, __m128i **pMoveScratch);
 
+    VerusHashContext *ctx;      // NULL: the thread's key space
+
     static inline uint64_t keymask(uint64_t keysize)
     {
         int i = 0;
@@ -155,8 +184,15 @@ struct verusclhasher {
         return i ? (((uint64_t)1) << i) - 1 : 0;
     }
 
+    // bytes from one Finalize2bN key to the next: the key and its move scratch, no refresh copy
+    static inline uint64_t keysstride(uint64_t keysize)
+    {
+        return (keysize << 1) - (keymask(keysize) + 1);
+    }
+
     // align on 256 bit boundary at end
-    verusclhasher(uint64_t keysize=VERUSKEYSIZE, int solutionVersion=SOLUTION_VERUSHHASH_V2) : keySizeInBytes((keysize >> 5) << 5)
+    verusclhasher(uint64_t keysize=VERUSKEYSIZE, int solutionVersion=SOLUTION_VERUSHHASH_V2, VerusHashContext *pctx=NULL) :
+        keySizeInBytes((keysize >> 5) << 5), ctx(pctx)
     {
 #ifdef __APPLE__
        __tls_init();
@@ -204,6 +240,21 @@ struct verusclhasher {
             }
         }
 
+        if (ctx)
+        {
+            // a context is never reallocated, it must already fit
+            if (ctx->key && keySizeInBytes == ctx->descr.keySizeInBytes)
+            {
+                keyMask = keymask(keySizeInBytes);
+            }
+            else
+            {
+                keyMask = 0;
+                keySizeInBytes = 0;
+            }
+            return;
+        }
+
         // if we changed, change it
         if (verusclhasher_key.get() && keySizeInBytes != ((verusclhash_descr *)verusclhasher_descr.get())->keySizeInBytes)
         {
@@ -240,10 +291,28 @@ struct verusclhasher {
 #endif
     }
 
+    inline unsigned char *gethasherkey() const
+    {
+        return ctx ? ctx->key : (unsigned char *)verusclhasher_key.get();
+    }
+
     inline void *gethasherrefresh()
     {
-        verusclhash_descr *pdesc = (verusclhash_descr *)verusclhasher_descr.get();
-        return (unsigned char *)verusclhasher_key.get() + pdesc->keySizeInBytes;
+        return gethasherkey() + gethasherdescription()->keySizeInBytes;
+    }
+
+    // space for the 8 keys of CVerusHashV2::Finalize2bN, allocated on first use for the thread's
+    inline unsigned char *gethasherkeys()
+    {
+        if (ctx)
+        {
+            return ctx->keys;
+        }
+        if (!verusclhasher_keys.get())
+        {
+            verusclhasher_keys.reset(alloc_aligned_buffer(keysstride(keySizeInBytes) << 3));
+        }
+        return (unsigned char *)verusclhasher_keys.get();
     }
 
     // returns a per thread, writeable scratch pad that has enough space to hold a pointer for each
@@ -255,7 +324,7 @@ struct verusclhasher {
 
     inline verusclhash_descr *gethasherdescription() const
     {
-        return (verusclhash_descr *)verusclhasher_descr.get();
+        return ctx ? &ctx->descr : (verusclhash_descr *)verusclhasher_descr.get();
     }
 
     inline uint64_t keyrefreshsize() const
@@ -279,18 +348,17 @@ struct verusclhasher {
     // WARNING!! this does not check for NULL ptr, so make sure the buffer is allocated
     inline void *gethashkey()
     {
-        unsigned char *ret = (unsigned char *)verusclhasher_key.get();
-        return fixupkey(ret, *(verusclhash_descr *)verusclhasher_descr.get());
+        return fixupkey(gethasherkey(), *gethasherdescription());
     }
 
     inline uint64_t operator()(const unsigned char buf[64]) const {
-        unsigned char *pkey = (unsigned char *)verusclhasher_key.get();
-        verusclhash_descr *pdesc = (verusclhash_descr *)verusclhasher_descr.get();
+        unsigned char *pkey = gethasherkey();
+        verusclhash_descr *pdesc = gethasherdescription();
         return (*verusclhashfunction)(pkey, buf, keyMask, (__m128i **)(pkey + (pdesc->keySizeInBytes + keyrefreshsize())));
     }
 
     inline uint64_t operator()(const unsigned char buf[64], void *pkey) const {
-        verusclhash_descr *pdesc = (verusclhash_descr *)verusclhasher_descr.get();
+        verusclhash_descr *pdesc = gethasherdescription();
         return (*verusclhashfunction)(pkey, buf, keyMask, (__m128i **)((unsigned char *)pkey + (pdesc->keySizeInBytes + keyrefreshsize())));
     }
 
@@ -299,6 +367,36 @@ struct verusclhasher {
     }
 };
 
+// backends of verusclhash_t
+enum { VERUSCLHASH_NATIVE = 0, VERUSCLHASH_PORTABLE = 1 };
+
+// the verusclhash variant a verusclhasher would pick for SolutionVersion, with the backend
+// fixed at compile time: VERUSCLHASH_NATIVE needs AES-NI and PCLMUL (IsCPUVerusOptimized).
+// the call is direct, so where the variant is defined (verus_clhash.cpp, verus_clhash_portable.cpp)
+// it inlines into the caller, see CVerusHashV2::Finalize2bT
+template <int SolutionVersion, int Backend>
+inline uint64_t verusclhash_t(void *random, const unsigned char buf[64], uint64_t keyMask, __m128i **pMoveScratch)
+{
+    if (Backend == VERUSCLHASH_NATIVE)
+    {
+        if (SolutionVersion >= SOLUTION_VERUSHHASH_V2_2)
+            return verusclhash_sv2_2(random, buf, keyMask, pMoveScratch);
+        else if (SolutionVersion >= SOLUTION_VERUSHHASH_V2_1)
+            return verusclhash_sv2_1(random, buf, keyMask, pMoveScratch);
+        else
+            return verusclhash(random, buf, keyMask, pMoveScratch);
+    }
+    else
+    {
+        if (SolutionVersion >= SOLUTION_VERUSHHASH_V2_2)
+            return verusclhash_sv2_2_port(random, buf, keyMask, pMoveScratch);
+        else if (SolutionVersion >= SOLUTION_VERUSHHASH_V2_1)
+            return verusclhash_sv2_1_port(random, buf, keyMask, pMoveScratch);
+        else
+            return verusclhash_port(random, buf, keyMask, pMoveScratch);
+    }
+}
+
 #endif // #ifdef __cplusplus
 
 #endif // INCLUDE_VERUS_CLHASH_H
@@ -44,270 +44,230 @@ extern "C" {
 #include <intrin.h>
 #endif
 
-void clmul64(uint64_t a, uint64_t b, uint64_t* r)
+// The emulation layer works on the two 64-bit halves of an __m128i. Going through memcpy keeps it
+// clear of strict aliasing, and compilers turn it into plain register moves.
+static inline uint64_t _mm_lo64_emu(const __m128i &a)
 {
-    uint8_t s = 4,i; //window size
-    uint64_t two_s = 1 << s; //2^s
-    uint64_t smask = two_s-1; //s 1 bits
-    uint64_t u[16];
-    uint64_t tmp;
-    uint64_t ifmask;
-    //Precomputation
-    u[0] = 0;
-    u[1] = b;
-    for(i = 2 ; i < two_s; i += 2){
-        u[i] = u[i >> 1] << 1; //even indices: left shift
-        u[i + 1] = u[i] ^ b; //odd indices: xor b
-    }
-    //Multiply
-    r[0] = u[a & smask]; //first window only affects lower word
-    r[1] = 0;
-    for(i = s ; i < 64 ; i += s){
-        tmp = u[a >> i & smask];     
-        r[0] ^= tmp << i;
-        r[1] ^= tmp >> (64 - i);
-    }
-    //Repair
-    uint64_t m = 0xEEEEEEEEEEEEEEEE; //s=4 => 16 times 1110
-    for(i = 1 ; i < s ; i++){
-        tmp = ((a & m) >> i);
-        m &= m << 1; //shift mask to exclude all bit j': j' mod s = i
-        ifmask = -((b >> (64-i)) & 1); //if the (64-i)th bit of b is 1
-        r[1] ^= (tmp & ifmask);
-    }
+    uint64_t r;
+    memcpy(&r, &a, 8);
+    return r;
 }
 
-u128 _mm_clmulepi64_si128_emu(const __m128i &a, const __m128i &b, int imm)
+static inline uint64_t _mm_hi64_emu(const __m128i &a)
 {
-    uint64_t result[2];
-    clmul64(*((uint64_t*)&a + (imm & 1)), *((uint64_t*)&b + ((imm & 0x10) >> 4)), result);
-
-    /*
-    // TEST
-    const __m128i tmp1 = _mm_load_si128(&a);
-    const __m128i tmp2 = _mm_load_si128(&b);
-    imm = imm & 0x11;
-    const __m128i testresult = (imm == 0x10) ? _mm_clmulepi64_si128(tmp1, tmp2, 0x10) : ((imm == 0x01) ? _mm_clmulepi64_si128(tmp1, tmp2, 0x01) : ((imm == 0x00) ? _mm_clmulepi64_si128(tmp1, tmp2, 0x00) : _mm_clmulepi64_si128(tmp1, tmp2, 0x11)));
-    if (!memcmp(&testresult, &result, 16))
-    {
-        printf("_mm_clmulepi64_si128_emu: Portable version passed!\n");
-    }
-    else
-    {
-        printf("_mm_clmulepi64_si128_emu: Portable version failed! a: %lxh %lxl, b: %lxh %lxl, imm: %x, emu: %lxh %lxl, intrin: %lxh %lxl\n", 
-               *((uint64_t *)&a + 1), *(uint64_t *)&a,
-               *((uint64_t *)&b + 1), *(uint64_t *)&b,
-               imm,
-               *((uint64_t *)result + 1), *(uint64_t *)result,
-               *((uint64_t *)&testresult + 1), *(uint64_t *)&testresult);
-        return testresult;
-    }
-    */
+    uint64_t r;
+    memcpy(&r, (const unsigned char *)&a + 8, 8);
+    return r;
+}
 
-    return *(__m128i *)result;
+static inline u128 _mm_set_epi64x_emu(uint64_t hi, uint64_t lo)
+{
+    const uint64_t halves[2] = {lo, hi};
+    __m128i result;
+    memcpy(&result, halves, 16);
+    return result;
 }
 
-u128 _mm_mulhrs_epi16_emu(__m128i _a, __m128i _b)
+// 64x64 bit carry-less product, 4 bits of a at a time from a table of b times every nibble. The table keeps
+// the (up to 3) bits of b * i that spill past bit 63 in thi, so no repair step is needed afterwards, and the
+// windows are independent of each other rather than one serial chain.
+static inline void clmul64(uint64_t a, uint64_t b, uint64_t* r)
 {
-    int16_t result[8];
-    int16_t *a = (int16_t*)&_a, *b = (int16_t*)&_b;
-    for (int i = 0; i < 8; i ++)
+    uint64_t tlo[16], thi[16];
+    tlo[0] = thi[0] = 0;
+    tlo[1] = b;
+    thi[1] = 0;
+    for (int i = 2; i < 16; i += 2)
     {
-        result[i] = (int16_t)((((int32_t)(a[i]) * (int32_t)(b[i])) + 0x4000) >> 15);
+        tlo[i] = tlo[i >> 1] << 1;
+        thi[i] = thi[i >> 1] << 1 | tlo[i >> 1] >> 63;
+        tlo[i + 1] = tlo[i] ^ b;
+        thi[i + 1] = thi[i];
     }
 
-    /*
-    const __m128i testresult = _mm_mulhrs_epi16(_a, _b);
-    if (!memcmp(&testresult, &result, 16))
+    uint64_t lo = tlo[a & 15], hi = thi[a & 15];
+    for (int i = 4; i < 64; i += 4)
     {
-        printf("_mm_mulhrs_epi16_emu: Portable version passed!\n");
+        const unsigned n = (a >> i) & 15;
+        lo ^= tlo[n] << i;
+        hi ^= tlo[n] >> (64 - i) ^ thi[n] << i;
     }
-    else
-    {
-        printf("_mm_mulhrs_epi16_emu: Portable version failed! a: %lxh %lxl, b: %lxh %lxl, emu: %lxh %lxl, intrin: %lxh %lxl\n", 
-               *((uint64_t *)&a + 1), *(uint64_t *)&a,
-               *((uint64_t *)&b + 1), *(uint64_t *)&b,
-               *((uint64_t *)result + 1), *(uint64_t *)result,
-               *((uint64_t *)&testresult + 1), *(uint64_t *)&testresult);
-    }
-    */
-
-    return *(__m128i *)result;
+    r[0] = lo;
+    r[1] = hi;
 }
 
-inline u128 _mm_set_epi64x_emu(uint64_t hi, uint64_t lo)
+static inline u128 _mm_clmulepi64_si128_emu(const __m128i &a, const __m128i &b, int imm)
 {
-    __m128i result;
-    ((uint64_t *)&result)[0] = lo;
-    ((uint64_t *)&result)[1] = hi;
-    return result;
+    uint64_t result[2];
+    clmul64(imm & 1 ? _mm_hi64_emu(a) : _mm_lo64_emu(a), imm & 0x10 ? _mm_hi64_emu(b) : _mm_lo64_emu(b), result);
+    return _mm_set_epi64x_emu(result[1], result[0]);
 }
 
-inline u128 _mm_cvtsi64_si128_emu(uint64_t lo)
+// a plain loop over the eight lanes, which compilers vectorize (to pmulhrsw itself with SSSE3)
+static inline u128 _mm_mulhrs_epi16_emu(__m128i _a, __m128i _b)
 {
-    __m128i result;
-    ((uint64_t *)&result)[0] = lo;
-    ((uint64_t *)&result)[1] = 0;
-    return result;
+    int16_t a[8], b[8], result[8];
+    memcpy(a, &_a, 16);
+    memcpy(b, &_b, 16);
+    for (int i = 0; i < 8; i ++)
+    {
+        result[i] = (int16_t)((((int32_t)(a[i]) * (int32_t)(b[i])) + 0x4000) >> 15);
+    }
+
+    __m128i r;
+    memcpy(&r, result, 16);
+    return r;
 }
 
-inline int64_t _mm_cvtsi128_si64_emu(const __m128i &a)
+static inline u128 _mm_cvtsi64_si128_emu(uint64_t lo)
 {
-    return *(int64_t *)&a;
+    return _mm_set_epi64x_emu(0, lo);
 }
 
-inline int32_t _mm_cvtsi128_si32_emu(const __m128i &a)
+static inline int64_t _mm_cvtsi128_si64_emu(const __m128i &a)
 {
-    return *(int32_t *)&a;
+    return (int64_t)_mm_lo64_emu(a);
 }
 
-inline u128 _mm_cvtsi32_si128_emu(uint32_t lo)
+static inline int32_t _mm_cvtsi128_si32_emu(const __m128i &a)
 {
-    __m128i result;
-    ((uint32_t *)&result)[0] = lo;
-    ((uint32_t *)&result)[1] = 0;
-    ((uint64_t *)&result)[1] = 0;
-
-    /*
-    const __m128i testresult = _mm_cvtsi32_si128(lo);
-    if (!memcmp(&testresult, &result, 16))
-    {
-        printf("_mm_cvtsi32_si128_emu: Portable version passed!\n");
-    }
-    else
-    {
-        printf("_mm_cvtsi32_si128_emu: Portable version failed!\n");
-    }
-    */
+    return (int32_t)_mm_lo64_emu(a);
+}
 
-    return result;
+static inline u128 _mm_cvtsi32_si128_emu(uint32_t lo)
+{
+    return _mm_set_epi64x_emu(0, lo);
 }
 
-u128 _mm_setr_epi8_emu(u_char c0, u_char c1, u_char c2, u_char c3, u_char c4, u_char c5, u_char c6, u_char c7, u_char c8, u_char c9, u_char c10, u_char c11, u_char c12, u_char c13, u_char c14, u_char c15)
+static inline u128 _mm_setr_epi8_emu(u_char c0, u_char c1, u_char c2, u_char c3, u_char c4, u_char c5, u_char c6, u_char c7, u_char c8, u_char c9, u_char c10, u_char c11, u_char c12, u_char c13, u_char c14, u_char c15)
 {
+    const uint8_t bytes[16] = {c0, c1, c2, c3, c4, c5, c6, c7, c8, c9, c10, c11, c12, c13, c14, c15};
     __m128i result;
-    ((uint8_t *)&result)[0] = c0;
-    ((uint8_t *)&result)[1] = c1;
-    ((uint8_t *)&result)[2] = c2;
-    ((uint8_t *)&result)[3] = c3;
-    ((uint8_t *)&result)[4] = c4;
-    ((uint8_t *)&result)[5] = c5;
-    ((uint8_t *)&result)[6] = c6;
-    ((uint8_t *)&result)[7] = c7;
-    ((uint8_t *)&result)[8] = c8;
-    ((uint8_t *)&result)[9] = c9;
-    ((uint8_t *)&result)[10] = c10;
-    ((uint8_t *)&result)[11] = c11;
-    ((uint8_t *)&result)[12] = c12;
-    ((uint8_t *)&result)[13] = c13;
-    ((uint8_t *)&result)[14] = c14;
-    ((uint8_t *)&result)[15] = c15;
-
-    /*
-    const __m128i testresult = _mm_setr_epi8(c0,c1,c2,c3,c4,c5,c6,c7,c8,c9,c10,c11,c12,c13,c14,c15);
-    if (!memcmp(&testresult, &result, 16))
-    {
-        printf("_mm_setr_epi8_emu: Portable version passed!\n");
-    }
-    else
-    {
-        printf("_mm_setr_epi8_emu: Portable version failed!\n");
-    }
-    */
-
+    memcpy(&result, bytes, 16);
     return result;
 }
 
-inline __m128i _mm_srli_si128_emu(__m128i a, int imm8)
+static inline __m128i _mm_srli_si128_emu(__m128i a, int imm8)
 {
-    unsigned char result[16];
-    uint8_t shift = imm8 & 0xff;
-    if (shift > 15) shift = 16;
-
-    int i;
-    for (i = 0; i < (16 - shift); i++)
-    {
-        result[i] = ((unsigned char *)&a)[shift + i];
-    }
-    for ( ; i < 16; i++)
-    {
-        result[i] = 0;
-    }
+    const unsigned shift = (imm8 & 0xff) > 15 ? 128 : (imm8 & 0xff) << 3;
+    uint64_t lo = _mm_lo64_emu(a), hi = _mm_hi64_emu(a);
 
-    /*
-    const __m128i tmp1 = _mm_load_si128(&a);
-    __m128i testresult = _mm_srli_si128(tmp1, imm8);
-    if (!memcmp(&testresult, result, 16))
+    if (shift >= 64)
     {
-        printf("_mm_srli_si128_emu: Portable version passed!\n");
+        lo = shift >= 128 ? 0 : hi >> (shift - 64);
+        hi = 0;
     }
-    else
+    else if (shift)
     {
-        printf("_mm_srli_si128_emu: Portable version failed! val: %lx%lx imm: %x emu: %lx%lx, intrin: %lx%lx\n", 
-               *((uint64_t *)&a + 1), *(uint64_t *)&a,
-               imm8,
-               *((uint64_t *)result + 1), *(uint64_t *)result,
-               *((uint64_t *)&testresult + 1), *(uint64_t *)&testresult);
+        lo = lo >> shift | hi << (64 - shift);
+        hi >>= shift;
     }
-    */
-
-    return *(__m128i *)result;
+    return _mm_set_epi64x_emu(hi, lo);
 }
 
-inline __m128i _mm_xor_si128_emu(__m128i a, __m128i b)
+static inline __m128i _mm_xor_si128_emu(__m128i a, __m128i b)
 {
 #ifdef _WIN32
-    uint64_t result[2];
-    result[0] = *(uint64_t *)&a ^ *(uint64_t *)&b;
-    result[1] = *((uint64_t *)&a + 1) ^ *((uint64_t *)&b + 1);
-    return *(__m128i *)result;
+    return _mm_set_epi64x_emu(_mm_hi64_emu(a) ^ _mm_hi64_emu(b), _mm_lo64_emu(a) ^ _mm_lo64_emu(b));
 #else
     return a ^ b;
 #endif
 }
 
-inline __m128i _mm_load_si128_emu(const void *p)
+static inline __m128i _mm_load_si128_emu(const void *p)
 {
-    return *(__m128i *)p;
+    __m128i result;
+    memcpy(&result, p, 16);
+    return result;
 }
 
-inline void _mm_store_si128_emu(void *p, __m128i val)
+static inline void _mm_store_si128_emu(void *p, __m128i val)
 {
-    *(__m128i *)p = val;
+    memcpy(p, &val, 16);
 }
 
-__m128i _mm_shuffle_epi8_emu(__m128i a, __m128i b)
+static inline __m128i _mm_shuffle_epi8_emu(__m128i a, __m128i b)
 {
-    __m128i result;
+    uint8_t src[16], sel[16], result[16];
+    memcpy(src, &a, 16);
+    memcpy(sel, &b, 16);
     for (int i = 0; i < 16; i++)
     {
-        if (((uint8_t *)&b)[i] & 0x80)
-        {
-            ((uint8_t *)&result)[i] = 0;
-        }
-        else
-        {
-            ((uint8_t *)&result)[i] = ((uint8_t *)&a)[((uint8_t *)&b)[i] & 0xf];
-        }
+        result[i] = sel[i] & 0x80 ? 0 : src[sel[i] & 0xf];
     }
 
-    /*
-    const __m128i tmp1 = _mm_load_si128(&a);
-    const __m128i tmp2 = _mm_load_si128(&b);
-    __m128i testresult = _mm_shuffle_epi8(tmp1, tmp2);
-    if (!memcmp(&testresult, &result, 16))
-    {
-        printf("_mm_shuffle_epi8_emu: Portable version passed!\n");
-    }
-    else
+    __m128i r;
+    memcpy(&r, result, 16);
+    return r;
+}
+
+// One AES round (_mm_aesenc_si128) from four T-tables, a column of output per four table lookups, in place
+// of the byte at a time aesenc of haraka_portable.c, which dominated the cost of the portable hashes.
+static constexpr uint8_t aes_sbox_port[256] =
+{ 0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe,
+  0xd7, 0xab, 0x76, 0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4,
+  0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0, 0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7,
+  0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15, 0x04, 0xc7, 0x23, 0xc3,
+  0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75, 0x09,
+  0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3,
+  0x2f, 0x84, 0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe,
+  0x39, 0x4a, 0x4c, 0x58, 0xcf, 0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85,
+  0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8, 0x51, 0xa3, 0x40, 0x8f, 0x92,
+  0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2, 0xcd, 0x0c,
+  0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19,
+  0x73, 0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14,
+  0xde, 0x5e, 0x0b, 0xdb, 0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2,
+  0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79, 0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5,
+  0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08, 0xba, 0x78, 0x25,
+  0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+  0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86,
+  0xc1, 0x1d, 0x9e, 0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e,
+  0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf, 0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42,
+  0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16 };
+
+struct AesTablesPort
+{
+    uint32_t t[4][256];
+
+    constexpr AesTablesPort() : t()
     {
-        printf("_mm_shuffle_epi8_emu: Portable version failed!\n");
+        for (int i = 0; i < 256; i++)
+        {
+            const uint32_t s = aes_sbox_port[i];
+            const uint32_t s2 = ((s << 1) ^ ((s >> 7) * 0x1b)) & 0xff;
+            const uint32_t col = s2 | s << 8 | s << 16 | (s2 ^ s) << 24;
+            for (int j = 0; j < 4; j++)
+            {
+                t[j][i] = col << (j << 3) | col >> ((32 - (j << 3)) & 31);
+            }
+        }
     }
-    */
+};
 
-    return result;
+static constexpr AesTablesPort aes_tables_port;
+
+static inline uint32_t aes_column_port(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3)
+{
+    return aes_tables_port.t[0][c0 & 0xff] ^ aes_tables_port.t[1][(c1 >> 8) & 0xff] ^
+           aes_tables_port.t[2][(c2 >> 16) & 0xff] ^ aes_tables_port.t[3][c3 >> 24];
 }
 
+static inline void aesenc_port(__m128i &s, const __m128i &rk)
+{
+    const uint64_t lo = _mm_lo64_emu(s), hi = _mm_hi64_emu(s);
+    const uint32_t c0 = (uint32_t)lo, c1 = (uint32_t)(lo >> 32), c2 = (uint32_t)hi, c3 = (uint32_t)(hi >> 32);
+
+    s = _mm_set_epi64x_emu(((uint64_t)aes_column_port(c3, c0, c1, c2) << 32 | aes_column_port(c2, c3, c0, c1)) ^ _mm_hi64_emu(rk),
+                           ((uint64_t)aes_column_port(c1, c2, c3, c0) << 32 | aes_column_port(c0, c1, c2, c3)) ^ _mm_lo64_emu(rk));
+}
+
+#undef AES2_EMU
+#define AES2_EMU(s0, s1, rci) \
+  aesenc_port(s0, rc[rci]); \
+  aesenc_port(s1, rc[rci + 1]); \
+  aesenc_port(s0, rc[rci + 2]); \
+  aesenc_port(s1, rc[rci + 3]);
+
 // portable
 static inline __m128i lazyLengthHash_port(uint64_t keylength, uint64_t length) {
     const __m128i lengthvector = _mm_set_epi64x_emu(keylength,length);
@@ -1201,3 +1161,8 @@ uint64_t verusclhash_sv2_2_port(void * random, const unsigned char buf[64], uint
     acc = _mm_xor_si128_emu(acc, lazyLengthHash_port(1024, 64));
     return precompReduction64_port(acc);
 }
+
+// the compile-time specialized Finalize2b, here so that the CLHASH above inlines into it
+template void CVerusHashV2::Finalize2bT<SOLUTION_VERUSHHASH_V2, VERUSCLHASH_PORTABLE>(unsigned char hash[32]);
+template void CVerusHashV2::Finalize2bT<SOLUTION_VERUSHHASH_V2_1, VERUSCLHASH_PORTABLE>(unsigned char hash[32]);
+template void CVerusHashV2::Finalize2bT<SOLUTION_VERUSHHASH_V2_2, VERUSCLHASH_PORTABLE>(unsigned char hash[32]);
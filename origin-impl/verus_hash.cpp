@@ -8,6 +8,7 @@ function with a Haraka V2 core. Unlike Haraka, which is made for short
 inputs only, Verus Hash takes any length of input and produces a 256 
 bit output.
 */
+#include <optional>
 #include <string.h>
 #include "common.h"
 #include "verus_hash.h"
@@ -103,6 +104,8 @@ void verus_hash(void *result, const void *data, size_t len)
 void (*CVerusHashV2::haraka512Function)(unsigned char *out, const unsigned char *in);
 void (*CVerusHashV2::haraka512KeyedFunction)(unsigned char *out, const unsigned char *in, const u128 *rc);
 void (*CVerusHashV2::haraka256Function)(unsigned char *out, const unsigned char *in);
+void (*CVerusHashV2::haraka256_4xFunction)(unsigned char *out, const unsigned char *in);
+void (*CVerusHashV2::haraka256_8xFunction)(unsigned char *out, const unsigned char *in);
 
 void CVerusHashV2::init()
 {
@@ -112,6 +115,8 @@ void CVerusHashV2::init()
         haraka512Function = &haraka512;
         haraka512KeyedFunction = &haraka512_keyed;
         haraka256Function = &haraka256;
+        haraka256_4xFunction = &haraka256_4x;
+        haraka256_8xFunction = haraka_vaes_level() ? &haraka256_vaes_8x : &haraka256_8x;
     }
     else
     {
@@ -120,6 +125,8 @@ void CVerusHashV2::init()
         haraka512Function = &haraka512_port;
         haraka512KeyedFunction = &haraka512_port_keyed;
         haraka256Function = &haraka256_port;
+        haraka256_4xFunction = &haraka256_port_4x;
+        haraka256_8xFunction = &haraka256_port_8x;
     }
 }
 
@@ -189,3 +196,74 @@ void verus_hash_v2(void *result, const void *data, size_t len)
 {
     return CVerusHashV2::Hash(result, data, len);
 }
+
+VerusHashContext *verus_hash_context_create(void)
+{
+    VerusHashContext *ctx = new VerusHashContext();
+    if (!ctx->key)
+    {
+        delete ctx;
+        return NULL;
+    }
+    return ctx;
+}
+
+void verus_hash_context_destroy(VerusHashContext *ctx)
+{
+    delete ctx;
+}
+
+template <int SolutionVersion>
+static void Finalize2bFor(CVerusHashV2 &vh, unsigned char *hash)
+{
+    if (IsCPUVerusOptimized())
+        vh.Finalize2bT<SolutionVersion, VERUSCLHASH_NATIVE>(hash);
+    else
+        vh.Finalize2bT<SolutionVersion, VERUSCLHASH_PORTABLE>(hash);
+}
+
+void verus_hash_v2b_ctx(VerusHashContext *ctx, int solutionVersion, void *result, const void *data, size_t len)
+{
+    CVerusHashV2 vh(solutionVersion, ctx);
+    vh.Write((const unsigned char *)data, len);
+    // the version is only known here, pick the specialized Finalize2b for it
+    if (solutionVersion >= SOLUTION_VERUSHHASH_V2_2)
+        Finalize2bFor<SOLUTION_VERUSHHASH_V2_2>(vh, (unsigned char *)result);
+    else if (solutionVersion >= SOLUTION_VERUSHHASH_V2_1)
+        Finalize2bFor<SOLUTION_VERUSHHASH_V2_1>(vh, (unsigned char *)result);
+    else
+        Finalize2bFor<SOLUTION_VERUSHHASH_V2>(vh, (unsigned char *)result);
+}
+
+// N messages through one Finalize2bN; CVerusHashV2 points into its own buffers, so the hashers
+// are built in place
+template <int N>
+static void Finalize2bGroup(VerusHashContext *ctx, int solutionVersion, unsigned char *results,
+                            const void *const *data, const size_t *len)
+{
+    std::optional<CVerusHashV2> vh[N];
+    CVerusHashV2 *hashers[N];
+    for (int i = 0; i < N; i++)
+    {
+        vh[i].emplace(solutionVersion, ctx);
+        vh[i]->Write((const unsigned char *)data[i], len[i]);
+        hashers[i] = &*vh[i];
+    }
+    CVerusHashV2::Finalize2bN<N>(hashers, results);
+}
+
+void verus_hash_v2b_ctx_batch(VerusHashContext *ctx, int solutionVersion, void *results,
+                              const void *const *data, const size_t *len, size_t count)
+{
+    unsigned char *out = (unsigned char *)results;
+    size_t i = 0;
+    for ( ; count - i >= 8; i += 8)
+        Finalize2bGroup<8>(ctx, solutionVersion, out + 32 * i, data + i, len + i);
+    if (count - i >= 4)
+    {
+        Finalize2bGroup<4>(ctx, solutionVersion, out + 32 * i, data + i, len + i);
+        i += 4;
+    }
+    for ( ; i < count; i++)
+        verus_hash_v2b_ctx(ctx, solutionVersion, out + 32 * i, data[i], len[i]);
+}
@@ -79,14 +79,17 @@ class CVerusHashV2
         static void (*haraka512Function)(unsigned char *out, const unsigned char *in);
         static void (*haraka512KeyedFunction)(unsigned char *out, const unsigned char *in, const u128 *rc);
         static void (*haraka256Function)(unsigned char *out, const unsigned char *in);
+        static void (*haraka256_4xFunction)(unsigned char *out, const unsigned char *in);
+        static void (*haraka256_8xFunction)(unsigned char *out, const unsigned char *in);
 
         static void init();
 
         verusclhasher vclh;
 
-        CVerusHashV2(int solutionVerusion=SOLUTION_VERUSHHASH_V2) : vclh(VERUSKEYSIZE, solutionVerusion) {
+        // ctx: the key space to hash with, NULL for the thread's
+        CVerusHashV2(int solutionVerusion=SOLUTION_VERUSHHASH_V2, VerusHashContext *ctx=NULL) : vclh(VERUSKEYSIZE, solutionVerusion, ctx) {
             // we must have allocated key space, or can't run
-            if (!verusclhasher_key.get())
+            if (!vclh.keySizeInBytes)
             {
                 printf("ERROR: failed to allocate hash buffer - terminating\n");
                 assert(false);
@@ -144,12 +147,16 @@ class CVerusHashV2
         // chains Haraka256 from 32 bytes to fill the key
         static u128 *GenNewCLKey(unsigned char *seedBytes32)
         {
-            unsigned char *key = (unsigned char *)verusclhasher_key.get();
-            verusclhash_descr *pdesc = (verusclhash_descr *)verusclhasher_descr.get();
+            return GenNewCLKey(seedBytes32, (unsigned char *)verusclhasher_key.get(), (verusclhash_descr *)verusclhasher_descr.get());
+        }
+
+        // the same for the key space of key and pdesc, the thread's or a VerusHashContext's
+        static u128 *GenNewCLKey(unsigned char *seedBytes32, unsigned char *key, verusclhash_descr *pdesc)
+        {
             int size = pdesc->keySizeInBytes;
             int refreshsize = verusclhasher::keymask(size) + 1;
             // skip keygen if it is the current key
-            if (pdesc->seed != *((uint256 *)seedBytes32))
+            if (!pdesc->keyValid || pdesc->seed != *((uint256 *)seedBytes32))
             {
                 // generate a new key by chain hashing with Haraka256 from the last curbuf
                 int n256blks = size >> 5;
@@ -169,6 +176,7 @@ class CVerusHashV2
                     memcpy(pkey, buf, nbytesExtra);
                 }
                 pdesc->seed = *((uint256 *)seedBytes32);
+                pdesc->keyValid = true;
                 memcpy(key + size, key, refreshsize);
             }
             else
@@ -180,6 +188,45 @@ class CVerusHashV2
             return (u128 *)key;
         }
 
+        // GenNewCLKey for N (4 or 8) seeds at once, without the seed cache: keys[i] gets the
+        // size bytes of key chained from seeds[i]. The N chains are independent, so every step
+        // hashes all of them with one haraka256_4x/8x call rather than waiting on one chain
+        template <int N>
+        static void GenNewCLKeys(unsigned char *const keys[N], const unsigned char *const seeds[N], int size)
+        {
+            static_assert(N == 4 || N == 8, "keys are generated 4 or 8 at a time");
+            void (*hashNx)(unsigned char *out, const unsigned char *in) = N == 4 ? haraka256_4xFunction : haraka256_8xFunction;
+            alignas(32) unsigned char bufs[2][N * 32];
+            unsigned char *psrc = bufs[0], *pdst = bufs[1], *tmp;
+            int n256blks = size >> 5;
+            int nbytesExtra = size & 0x1f;
+
+            for (int j = 0; j < N; j++)
+            {
+                memcpy(psrc + (j << 5), seeds[j], 32);
+            }
+            for (int i = 0; i < n256blks; i++)
+            {
+                (*hashNx)(pdst, psrc);
+                for (int j = 0; j < N; j++)
+                {
+                    memcpy(keys[j] + (i << 5), pdst + (j << 5), 32);
+                }
+                tmp = psrc;
+                psrc = pdst;
+                pdst = tmp;
+            }
+            if (nbytesExtra)
+            {
+                (*hashNx)(pdst, psrc);
+                for (int j = 0; j < N; j++)
+                {
+                    memcpy(keys[j] + (n256blks << 5), pdst + (j << 5), nbytesExtra);
+                }
+            }
+        }
+
+
         inline uint64_t IntermediateTo128Offset(uint64_t intermediate)
         {
             // the mask is where we wrap
@@ -200,7 +247,7 @@ class CVerusHashV2
 #endif
 
             // gen new key with what is last in buffer
-            u128 *key = GenNewCLKey(curBuf);
+            u128 *key = GenNewCLKey(curBuf, vclh.gethasherkey(), vclh.gethasherdescription());
 
             // run verusclhash on the buffer
             uint64_t intermediate = vclh(curBuf, key);
@@ -220,6 +267,50 @@ class CVerusHashV2
             (*haraka512KeyedFunction)(hash, curBuf, key + IntermediateTo128Offset(intermediate));
         }
 
+        // Finalize2b for N (4 or 8) hashers at once, e.g. one per nonce: all N keys are generated
+        // together by GenNewCLKeys into the Finalize2bN key space of hashers[0] (its context's, or
+        // the thread's), then each hasher finishes as in Finalize2b. hashers[i]'s hash goes to
+        // hashes + 32 * i. the single key and its seed cache are not used, so a zero seed gets a
+        // derived key here, never a stale one
+        template <int N>
+        static void Finalize2bN(CVerusHashV2 *const hashers[N], unsigned char *hashes)
+        {
+            unsigned char *keys = hashers[0]->vclh.gethasherkeys();
+            if (!keys)
+            {
+                printf("ERROR: failed to allocate hash buffer - terminating\n");
+                assert(false);
+            }
+
+            uint64_t stride = verusclhasher::keysstride(hashers[0]->vclh.keySizeInBytes);
+            unsigned char *pkeys[N];
+            const unsigned char *seeds[N];
+            for (int i = 0; i < N; i++)
+            {
+                hashers[i]->FillExtra((u128 *)hashers[i]->curBuf);
+                pkeys[i] = keys + i * stride;
+                seeds[i] = hashers[i]->curBuf;
+            }
+
+            GenNewCLKeys<N>(pkeys, seeds, hashers[0]->vclh.keySizeInBytes);
+
+            for (int i = 0; i < N; i++)
+            {
+                CVerusHashV2 &h = *hashers[i];
+                u128 *key = (u128 *)pkeys[i];
+                uint64_t intermediate = h.vclh(h.curBuf, key, (__m128i **)(pkeys[i] + h.vclh.keySizeInBytes));
+                h.FillExtra(&intermediate);
+                (*haraka512KeyedFunction)(hashes + (i << 5), h.curBuf, key + h.IntermediateTo128Offset(intermediate));
+            }
+        }
+
+        // Finalize2b with the CLHASH of one solution version and backend (VERUSCLHASH_NATIVE or
+        // _PORTABLE) chosen at compile time instead of through vclh's function pointer. instantiated
+        // for each in verus_clhash.cpp and verus_clhash_portable.cpp, next to the CLHASH code, so the
+        // loop and its reduction inline into the hash
+        template <int SolutionVersion, int Backend>
+        void Finalize2bT(unsigned char hash[32]);
+
         inline unsigned char *CurBuffer()
         {
             return curBuf;
@@ -232,7 +323,51 @@ class CVerusHashV2
         size_t curPos = 0;
 };
 
+// flatten: the CLHASH variant and everything it calls, lazyLengthHash and precompReduction64
+// included, inline here wherever this is instantiated next to them
+template <int SolutionVersion, int Backend>
+__attribute__((flatten)) void CVerusHashV2::Finalize2bT(unsigned char hash[32])
+{
+    FillExtra((u128 *)curBuf);
+
+    u128 *key = GenNewCLKey(curBuf, vclh.gethasherkey(), vclh.gethasherdescription());
+    __m128i **pMoveScratch = (__m128i **)((unsigned char *)key + (vclh.gethasherdescription()->keySizeInBytes + vclh.keyrefreshsize()));
+
+    uint64_t intermediate = verusclhash_t<SolutionVersion, Backend>(key, curBuf, vclh.keyMask, pMoveScratch);
+
+    FillExtra(&intermediate);
+
+    (*haraka512KeyedFunction)(hash, curBuf, key + IntermediateTo128Offset(intermediate));
+}
+
+extern template void CVerusHashV2::Finalize2bT<SOLUTION_VERUSHHASH_V2, VERUSCLHASH_NATIVE>(unsigned char hash[32]);
+extern template void CVerusHashV2::Finalize2bT<SOLUTION_VERUSHHASH_V2_1, VERUSCLHASH_NATIVE>(unsigned char hash[32]);
+extern template void CVerusHashV2::Finalize2bT<SOLUTION_VERUSHHASH_V2_2, VERUSCLHASH_NATIVE>(unsigned char hash[32]);
+extern template void CVerusHashV2::Finalize2bT<SOLUTION_VERUSHHASH_V2, VERUSCLHASH_PORTABLE>(unsigned char hash[32]);
+extern template void CVerusHashV2::Finalize2bT<SOLUTION_VERUSHHASH_V2_1, VERUSCLHASH_PORTABLE>(unsigned char hash[32]);
+extern template void CVerusHashV2::Finalize2bT<SOLUTION_VERUSHHASH_V2_2, VERUSCLHASH_PORTABLE>(unsigned char hash[32]);
+extern template void CVerusHashV2::GenNewCLKeys<4>(unsigned char *const keys[4], const unsigned char *const seeds[4], int size);
+extern template void CVerusHashV2::GenNewCLKeys<8>(unsigned char *const keys[8], const unsigned char *const seeds[8], int size);
+extern template void CVerusHashV2::Finalize2bN<4>(CVerusHashV2 *const hashers[4], unsigned char *hashes);
+extern template void CVerusHashV2::Finalize2bN<8>(CVerusHashV2 *const hashers[8], unsigned char *hashes);
+
 extern void verus_hash(void *result, const void *data, size_t len);
 extern void verus_hash_v2(void *result, const void *data, size_t len);
 
+extern "C"
+{
+// a VerusHashContext for one worker; NULL if its key space cannot be allocated
+VerusHashContext *verus_hash_context_create(void);
+void verus_hash_context_destroy(VerusHashContext *ctx);
+
+// Write and Finalize2b of CVerusHashV2(solutionVersion) over data, with the key space of ctx,
+// or the thread's when ctx is NULL
+void verus_hash_v2b_ctx(VerusHashContext *ctx, int solutionVersion, void *result, const void *data, size_t len);
+
+// verus_hash_v2b_ctx for count messages, data[i] of len[i] bytes, into results + 32 * i: eight,
+// then four at a time through Finalize2bN, which generates their keys together, the rest one by one
+void verus_hash_v2b_ctx_batch(VerusHashContext *ctx, int solutionVersion, void *results,
+                              const void *const *data, const size_t *len, size_t count);
+}
+
 #endif
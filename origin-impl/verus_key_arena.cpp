@@ -0,0 +1,242 @@
+/*
+Key arena for VerusHash 2.x workers, see verus_key_arena.h
+*/
+#include "verus_key_arena.h"
+
+#include <string.h>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define HUGEPAGESIZE (2ULL << 20)
+
+#ifdef __linux__
+#define MPOL_PREFERRED 1        // <numaif.h>, without linking libnuma
+#endif
+
+static inline uint64_t RoundUp(uint64_t size, uint64_t to)
+{
+    return (size + to - 1) / to * to;
+}
+
+static const char *BackingName(VerusKeyArena::Backing backing)
+{
+    switch (backing)
+    {
+        case VerusKeyArena::HUGETLB:
+            return "hugetlb";
+        case VerusKeyArena::THP:
+            return "thp";
+        default:
+            return "pages";
+    }
+}
+
+#ifdef __linux__
+// an anonymous mapping of size bytes starting on a hugepage boundary, so that transparent
+// hugepages can back all of it; NULL on failure
+static unsigned char *MapHugeAligned(uint64_t size)
+{
+    void *p = mmap(NULL, size + HUGEPAGESIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+    {
+        return NULL;
+    }
+    unsigned char *raw = (unsigned char *)p;
+    unsigned char *base = (unsigned char *)RoundUp((uint64_t)raw, HUGEPAGESIZE);
+    if (base > raw)
+    {
+        munmap(raw, base - raw);
+    }
+    munmap(base + size, (raw + size + HUGEPAGESIZE) - (base + size));
+    return base;
+}
+#endif
+
+VerusKeyArena::VerusKeyArena(const std::vector<int> &workerCpus, uint32_t keysize)
+{
+#ifdef __linux__
+    pageSize = sysconf(_SC_PAGESIZE);
+#else
+    pageSize = 4096;
+#endif
+    uint64_t regionSize = RoundUp(VerusHashContext::SpaceSize(keysize), pageSize);
+
+    // nodes in order of first appearance, workers of a node consecutive within its mapping
+    std::vector<int> slot(workerCpus.size());
+    std::vector<int> count;
+    regions.resize(workerCpus.size());
+    for (size_t i = 0; i < workerCpus.size(); i++)
+    {
+        Region &r = regions[i];
+        r.cpu = workerCpus[i];
+        r.node = r.cpu < 0 ? -1 : NodeOfCpu(r.cpu);
+        r.base = NULL;
+        r.size = regionSize;
+        size_t m = 0;
+        while (m < mappings.size() && mappings[m].node != r.node)
+        {
+            m++;
+        }
+        if (m == mappings.size())
+        {
+            mappings.push_back(Mapping{r.node, NULL, 0, PAGES, false});
+            count.push_back(0);
+        }
+        slot[i] = count[m]++;
+    }
+
+    for (size_t m = 0; m < mappings.size(); m++)
+    {
+        Mapping &map = mappings[m];
+        map.size = RoundUp(count[m] * regionSize, HUGEPAGESIZE);
+#ifdef __linux__
+        void *p = mmap(NULL, map.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+        {
+            map.base = (unsigned char *)p;
+            map.backing = HUGETLB;
+        }
+        else if ((map.base = MapHugeAligned(map.size)))
+        {
+            map.backing = madvise(map.base, map.size, MADV_HUGEPAGE) ? PAGES : THP;
+        }
+        if (map.base && map.node >= 0)
+        {
+            unsigned long nodemask[16] = {0};
+            if (map.node < (int)(sizeof(nodemask) * 8) - 1)
+            {
+                nodemask[map.node / (sizeof(unsigned long) * 8)] |= 1UL << (map.node % (sizeof(unsigned long) * 8));
+                map.bound = !syscall(SYS_mbind, map.base, map.size, MPOL_PREFERRED, nodemask, sizeof(nodemask) * 8, 0);
+            }
+        }
+#else
+        void *p = NULL;
+        map.base = posix_memalign(&p, pageSize, map.size) ? NULL : (unsigned char *)p;
+#endif
+        if (!map.base)
+        {
+            return;
+        }
+        // first touch, now that the pages know where to go
+        memset(map.base, 0, map.size);
+    }
+
+    for (size_t i = 0; i < regions.size(); i++)
+    {
+        Region &r = regions[i];
+        size_t m = 0;
+        while (mappings[m].node != r.node)
+        {
+            m++;
+        }
+        r.base = mappings[m].base + slot[i] * regionSize;
+        r.backing = mappings[m].backing;
+        r.bound = mappings[m].bound;
+        contexts.push_back(new VerusHashContext(r.base, keysize));
+    }
+}
+
+VerusKeyArena::~VerusKeyArena()
+{
+    for (VerusHashContext *ctx : contexts)
+    {
+        delete ctx;
+    }
+    for (Mapping &map : mappings)
+    {
+        if (!map.base)
+        {
+            continue;
+        }
+#ifdef __linux__
+        munmap(map.base, map.size);
+#else
+        free(map.base);
+#endif
+    }
+}
+
+void VerusKeyArena::Layout(FILE *out) const
+{
+    fprintf(out, "VerusKeyArena: %zu workers, %zu mappings, page %lu, hugepage %llu\n",
+            regions.size(), mappings.size(), (unsigned long)pageSize, HUGEPAGESIZE);
+    for (const Mapping &map : mappings)
+    {
+        fprintf(out, "  node %2d: %p + %9lu  %-7s %s\n", map.node, (void *)map.base, (unsigned long)map.size,
+                BackingName(map.backing), map.bound ? "bound" : "unbound");
+    }
+    for (size_t i = 0; i < regions.size(); i++)
+    {
+        const Region &r = regions[i];
+        fprintf(out, "  worker %3zu: cpu %3d node %2d  %p + %lu\n", i, r.cpu, r.node, (void *)r.base, (unsigned long)r.size);
+    }
+}
+
+int VerusKeyArena::NodeOfCpu(int cpu)
+{
+#ifdef __linux__
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR *dir = opendir(path);
+    if (!dir)
+    {
+        return -1;
+    }
+    int node = -1;
+    for (struct dirent *e = readdir(dir); e; e = readdir(dir))
+    {
+        if (sscanf(e->d_name, "node%d", &node) == 1)
+        {
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+#else
+    return -1;
+#endif
+}
+
+int VerusKeyArena::CurrentCpu()
+{
+#ifdef __linux__
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+VerusKeyArena *verus_key_arena_create(const int *cpus, int n)
+{
+    if (n < 0 || (n > 0 && !cpus))
+    {
+        return NULL;
+    }
+    VerusKeyArena *arena = new VerusKeyArena(std::vector<int>(cpus, cpus + n));
+    if (!arena->IsValid())
+    {
+        delete arena;
+        return NULL;
+    }
+    return arena;
+}
+
+VerusHashContext *verus_key_arena_context(VerusKeyArena *arena, int i)
+{
+    if (!arena || i < 0 || (size_t)i >= arena->Workers())
+    {
+        return NULL;
+    }
+    return arena->Context(i);
+}
+
+void verus_key_arena_destroy(VerusKeyArena *arena)
+{
+    delete arena;
+}
@@ -0,0 +1,87 @@
+/*
+Key arena for VerusHash 2.x workers
+
+Every worker gets its own VerusHashContext (key, refresh copy, move scratch
+and the Finalize2bN keys) in a region aligned and padded to whole base pages,
+so no two workers share a cache line or a base page; with hugepage backing,
+the workers of a node do share its 2 MB pages. The regions of workers pinned
+to the same NUMA node are carved from one mapping for that node, which is
+bound to the node (mbind, preferred) before it is first touched and backed
+by 2 MB hugepages: reserved ones (MAP_HUGETLB) when the system has enough,
+else transparent ones (MADV_HUGEPAGE). Layout() prints where it all landed.
+
+Hugepages and node binding are Linux only; elsewhere each node's regions
+come from one page aligned posix_memalign block.
+*/
+#ifndef VERUS_KEY_ARENA_H_
+#define VERUS_KEY_ARENA_H_
+
+#include <stdio.h>
+#include <vector>
+
+#include "verus_hash.h"
+
+class VerusKeyArena
+{
+    public:
+        // what backs a node's mapping
+        enum Backing { HUGETLB, THP, PAGES };
+
+        struct Region
+        {
+            int cpu;                // CPU the worker is pinned to, -1 if none
+            int node;               // NUMA node of cpu, -1 if unknown
+            unsigned char *base;    // page aligned
+            uint64_t size;          // whole pages, VerusHashContext::SpaceSize rounded up
+            Backing backing;
+            bool bound;             // the mapping is bound to node
+        };
+
+        // one region per entry of workerCpus, the CPU that worker is (or will be) pinned to
+        VerusKeyArena(const std::vector<int> &workerCpus, uint32_t keysize=VERUSKEYSIZE);
+        ~VerusKeyArena();
+        VerusKeyArena(const VerusKeyArena &) = delete;
+        VerusKeyArena &operator=(const VerusKeyArena &) = delete;
+
+        // false if any node's mapping could not be allocated
+        bool IsValid() const { return contexts.size() == regions.size(); }
+
+        size_t Workers() const { return regions.size(); }
+        VerusHashContext *Context(int worker) { return contexts[worker]; }
+        const std::vector<Region> &Regions() const { return regions; }
+
+        // one line per node mapping, then one per worker region
+        void Layout(FILE *out) const;
+
+        // NUMA node of a CPU from sysfs, -1 if unknown
+        static int NodeOfCpu(int cpu);
+        // CPU the calling thread runs on, -1 if unknown
+        static int CurrentCpu();
+
+    private:
+        struct Mapping
+        {
+            int node;
+            unsigned char *base;
+            uint64_t size;
+            Backing backing;
+            bool bound;
+        };
+
+        uint64_t pageSize;
+        std::vector<Mapping> mappings;
+        std::vector<Region> regions;
+        std::vector<VerusHashContext *> contexts;
+};
+
+extern "C"
+{
+// an arena for n workers pinned to cpus[0..n) (-1: not pinned); NULL if n < 0, if cpus is NULL
+// for n > 0, or if it cannot be allocated
+VerusKeyArena *verus_key_arena_create(const int *cpus, int n);
+// the context of worker i, for verus_hash_v2b_ctx; NULL if i is not in [0, Workers())
+VerusHashContext *verus_key_arena_context(VerusKeyArena *arena, int i);
+void verus_key_arena_destroy(VerusKeyArena *arena);
+}
+
+#endif
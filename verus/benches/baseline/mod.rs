@@ -0,0 +1,193 @@
+//! JSON baselines of a bench run, and comparison against one.
+//!
+//! Criterion leaves `new/benchmark.json` and `new/estimates.json` per
+//! benchmark under its output directory; after the run, the benchmarks
+//! written since it started are collected by id with their mean and
+//! median (ns per iteration). Controlled by environment variables,
+//! because criterion rejects command line flags it does not know:
+//!
+//! * `VERUS_BENCH_SAVE=<file>`: write the run to `<file>`.
+//! * `VERUS_BENCH_COMPARE=<file>`: print every benchmark against
+//!   `<file>` and fail if any mean got slower by more than the threshold.
+//! * `VERUS_BENCH_THRESHOLD=<percent>`: the threshold, 5 by default.
+//!
+//! The baseline looks like
+//! `{"version":1,"benchmarks":{"verus_hash_v2/portable/fixed/80":{"mean_ns":…,"median_ns":…}}}`.
+
+use serde_json::{json, Map, Value};
+use std::collections::BTreeMap;
+use std::fs;
+use std::path::{Path, PathBuf};
+use std::time::SystemTime;
+
+const VERSION: u64 = 1;
+const DEFAULT_THRESHOLD: f64 = 5.0;
+
+#[derive(Clone, Copy)]
+struct Estimate {
+    mean_ns: f64,
+    median_ns: f64,
+}
+
+/// Saves and/or compares the benchmarks written since `started`, as the
+/// environment asks; `false` if there is a regression or an error.
+pub fn run(started: SystemTime) -> bool {
+    let save = std::env::var_os("VERUS_BENCH_SAVE").map(PathBuf::from);
+    let compare = std::env::var_os("VERUS_BENCH_COMPARE").map(PathBuf::from);
+    if save.is_none() && compare.is_none() {
+        return true;
+    }
+
+    let current = collect(&criterion_dir(), started);
+    if current.is_empty() {
+        eprintln!("baseline: no benchmark results written by this run");
+        return false;
+    }
+
+    let mut ok = true;
+    if let Some(path) = compare {
+        let threshold = match std::env::var("VERUS_BENCH_THRESHOLD") {
+            Ok(value) => match value.parse::<f64>() {
+                Ok(percent) if percent >= 0.0 => percent,
+                _ => {
+                    eprintln!("baseline: VERUS_BENCH_THRESHOLD={value} is not a percentage");
+                    return false;
+                }
+            },
+            Err(_) => DEFAULT_THRESHOLD,
+        };
+        ok &= match load(&path) {
+            Ok(base) => report(&base, &current, threshold),
+            Err(e) => {
+                eprintln!("baseline: {}: {e}", path.display());
+                false
+            }
+        };
+    }
+    if let Some(path) = save {
+        match store(&path, &current) {
+            Ok(()) => println!("baseline: saved {} benchmarks to {}", current.len(), path.display()),
+            Err(e) => {
+                eprintln!("baseline: {}: {e}", path.display());
+                ok = false;
+            }
+        }
+    }
+    ok
+}
+
+/// Where criterion writes: `CRITERION_HOME`, else `criterion/` in the
+/// cargo target directory, which is three levels above the bench
+/// executable (`target/<profile>/deps/<bench>`).
+fn criterion_dir() -> PathBuf {
+    if let Some(home) = std::env::var_os("CRITERION_HOME") {
+        return PathBuf::from(home);
+    }
+    if let Some(target) = std::env::var_os("CARGO_TARGET_DIR") {
+        return PathBuf::from(target).join("criterion");
+    }
+    let exe = std::env::current_exe().unwrap_or_default();
+    exe.ancestors().nth(3).unwrap_or(Path::new("target")).join("criterion")
+}
+
+/// Every `new/` result under `dir` modified since `started`, by full id.
+fn collect(dir: &Path, started: SystemTime) -> BTreeMap<String, Estimate> {
+    let mut found = BTreeMap::new();
+    let mut pending = vec![dir.to_path_buf()];
+    while let Some(dir) = pending.pop() {
+        let Ok(entries) = fs::read_dir(&dir) else { continue };
+        for entry in entries.flatten() {
+            let path = entry.path();
+            if !path.is_dir() {
+                continue;
+            }
+            if path.file_name().map_or(true, |name| name != "new") {
+                pending.push(path);
+                continue;
+            }
+            let estimates = path.join("estimates.json");
+            let fresh = fs::metadata(&estimates)
+                .and_then(|meta| meta.modified())
+                .map_or(false, |modified| modified >= started);
+            if !fresh {
+                continue;
+            }
+            if let (Some(benchmark), Some(estimates)) = (read_json(&path.join("benchmark.json")), read_json(&estimates)) {
+                let point = |name: &str| estimates[name]["point_estimate"].as_f64();
+                if let (Some(id), Some(mean_ns), Some(median_ns)) =
+                    (benchmark["full_id"].as_str(), point("mean"), point("median"))
+                {
+                    found.insert(id.to_string(), Estimate { mean_ns, median_ns });
+                }
+            }
+        }
+    }
+    found
+}
+
+fn read_json(path: &Path) -> Option<Value> {
+    serde_json::from_slice(&fs::read(path).ok()?).ok()
+}
+
+fn store(path: &Path, current: &BTreeMap<String, Estimate>) -> Result<(), String> {
+    let benchmarks: Map<String, Value> = current
+        .iter()
+        .map(|(id, e)| (id.clone(), json!({ "mean_ns": e.mean_ns, "median_ns": e.median_ns })))
+        .collect();
+    let text = serde_json::to_string_pretty(&json!({ "version": VERSION, "benchmarks": benchmarks }))
+        .map_err(|e| e.to_string())?;
+    fs::write(path, text + "\n").map_err(|e| e.to_string())
+}
+
+fn load(path: &Path) -> Result<BTreeMap<String, Estimate>, String> {
+    let value = read_json(path).ok_or("not a readable JSON file")?;
+    if value["version"].as_u64() != Some(VERSION) {
+        return Err(format!("not a version {VERSION} baseline"));
+    }
+    let benchmarks = value["benchmarks"].as_object().ok_or("no benchmarks")?;
+    benchmarks
+        .iter()
+        .map(|(id, e)| match (e["mean_ns"].as_f64(), e["median_ns"].as_f64()) {
+            (Some(mean_ns), Some(median_ns)) => Ok((id.clone(), Estimate { mean_ns, median_ns })),
+            _ => Err(format!("{id}: missing mean_ns or median_ns")),
+        })
+        .collect()
+}
+
+/// Prints each benchmark of this run against the baseline, worst first;
+/// `false` if any mean is more than `threshold` percent slower.
+fn report(base: &BTreeMap<String, Estimate>, current: &BTreeMap<String, Estimate>, threshold: f64) -> bool {
+    let mut rows: Vec<(&str, f64, f64, f64)> = current
+        .iter()
+        .filter_map(|(id, now)| {
+            let was = base.get(id)?;
+            Some((id.as_str(), was.mean_ns, now.mean_ns, (now.mean_ns / was.mean_ns - 1.0) * 100.0))
+        })
+        .collect();
+    rows.sort_by(|a, b| b.3.total_cmp(&a.3));
+
+    let width = rows.iter().map(|row| row.0.len()).max().unwrap_or(0);
+    println!("\n{:width$}  {:>12}  {:>12}  {:>8}", "benchmark", "base ns", "now ns", "change");
+    let mut regressions = 0;
+    for (id, was, now, change) in &rows {
+        let flag = if *change > threshold {
+            regressions += 1;
+            "  REGRESSION"
+        } else if *change < -threshold {
+            "  improved"
+        } else {
+            ""
+        };
+        println!("{id:width$}  {was:>12.1}  {now:>12.1}  {change:>+7.1}%{flag}");
+    }
+
+    let missing = current.keys().filter(|id| !base.contains_key(*id)).count();
+    if missing > 0 {
+        println!("{missing} benchmarks are not in the baseline");
+    }
+    println!(
+        "{} compared, {regressions} slower than the baseline by more than {threshold}%",
+        rows.len()
+    );
+    regressions == 0
+}
@@ -0,0 +1,285 @@
+//! Criterion benchmarks for the verus crate.
+//!
+//! Every hash entry point (single, context, batch, midstate, streaming,
+//! nonce search) is run over the message sizes in [`SIZES`], once on a
+//! fixed message and once cycling through a pool of random ones, and on
+//! x86 once per Haraka engine level the CPU supports (portable, SSSE3,
+//! AVX2). Throughput is in elements, i.e. hashes, so criterion's
+//! `elem/s` is the client's `H/s`.
+//!
+//! ```text
+//! cargo bench -p verus --bench verus_hash                     # run
+//! VERUS_BENCH_SAVE=base.json cargo bench -p verus --bench verus_hash
+//! VERUS_BENCH_COMPARE=base.json cargo bench -p verus --bench verus_hash
+//! ```
+//!
+//! See `baseline/mod.rs` for the JSON baseline and the comparison.
+
+use criterion::{black_box, criterion_group, BenchmarkGroup, BenchmarkId, Criterion, Throughput};
+use criterion::measurement::WallTime;
+use std::time::SystemTime;
+use verus::{
+    difficulty_to_target, hash_batch_into, hash_batch_v1_into, search_v2, verify_hash, verus_hash_v1,
+    verus_hash_v2, verus_hash_v2b, VerusHashContext, VerusHasher, VerusMidstate, SEARCH_MAX_LEN,
+};
+
+mod baseline;
+
+/// Message sizes: a bare hash, two hashes, a block header prefix, a
+/// challenge with a nonce, and a large transaction.
+const SIZES: [usize; 5] = [32, 64, 80, 140, 1487];
+
+/// Messages in a random pool; one batch call hashes all of them.
+const POOL: usize = 64;
+
+/// Nonces per [`search_v2`] scan.
+const SEARCH_NONCES: u64 = 256;
+
+/// Fixed or random messages of one size: `fixed` is one message, `pool`
+/// holds [`POOL`] random ones back to back.
+struct Inputs {
+    size: usize,
+    fixed: Vec<u8>,
+    pool: Vec<u8>,
+}
+
+impl Inputs {
+    fn new(size: usize) -> Self {
+        // xorshift64*, seeded per size so the pools are the same every run
+        let mut state = 0x9e37_79b9_7f4a_7c15u64 ^ size as u64;
+        let mut pool = vec![0u8; size * POOL];
+        for byte in pool.iter_mut() {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            *byte = (state.wrapping_mul(0x2545_f491_4f6c_dd1d) >> 56) as u8;
+        }
+        let fixed = (0..size).map(|i| i as u8).collect();
+        Self { size, fixed, pool }
+    }
+
+    fn message(&self, i: usize) -> &[u8] {
+        let i = i % POOL;
+        &self.pool[i * self.size..(i + 1) * self.size]
+    }
+}
+
+/// Runs `f` on the fixed message and on the random pool, one message per
+/// iteration, under `backend/fixed/size` and `backend/random/size`.
+fn bench_inputs<R>(
+    group: &mut BenchmarkGroup<'_, WallTime>,
+    backend: &str,
+    inputs: &Inputs,
+    mut f: impl FnMut(&[u8]) -> R,
+) {
+    group.throughput(Throughput::Elements(1));
+    group.bench_function(BenchmarkId::new(format!("{backend}/fixed"), inputs.size), |b| {
+        b.iter(|| f(black_box(&inputs.fixed)))
+    });
+    let mut i = 0;
+    group.bench_function(BenchmarkId::new(format!("{backend}/random"), inputs.size), |b| {
+        b.iter(|| {
+            i += 1;
+            f(black_box(inputs.message(i)))
+        })
+    });
+}
+
+/// The Haraka engine levels of the C library (see `c/haraka_dispatch.h`).
+/// On x86 the engines are picked at run time, and each level the CPU
+/// supports is benchmarked in turn; elsewhere only the portable one exists.
+#[cfg(any(target_arch = "x86", target_arch = "x86_64"))]
+mod backends {
+    extern "C" {
+        fn ForceCPUHarakaOptimized(level: i32);
+        fn IsCPUHarakaOptimized() -> i32;
+    }
+
+    const NAMES: [&str; 3] = ["portable", "ssse3", "avx2"];
+
+    /// Levels the CPU supports, by name.
+    pub fn available() -> Vec<(i32, &'static str)> {
+        let levels = (0..NAMES.len() as i32).filter(|&level| select(level)).collect::<Vec<_>>();
+        reset();
+        levels.into_iter().map(|level| (level, NAMES[level as usize])).collect()
+    }
+
+    /// Pins the engines to `level`; `false` if the CPU does not have it.
+    pub fn select(level: i32) -> bool {
+        unsafe {
+            ForceCPUHarakaOptimized(level);
+            IsCPUHarakaOptimized() == level
+        }
+    }
+
+    /// Back to what the CPU probe picks.
+    pub fn reset() {
+        unsafe { ForceCPUHarakaOptimized(-1) }
+    }
+}
+
+#[cfg(not(any(target_arch = "x86", target_arch = "x86_64")))]
+mod backends {
+    pub fn available() -> Vec<(i32, &'static str)> {
+        vec![(0, "portable")]
+    }
+
+    pub fn select(_level: i32) -> bool {
+        true
+    }
+
+    pub fn reset() {}
+}
+
+/// Runs `f` once per available backend, with the engines pinned to it.
+fn for_each_backend(mut f: impl FnMut(&str)) {
+    for (level, name) in backends::available() {
+        if backends::select(level) {
+            f(name);
+        }
+    }
+    backends::reset();
+}
+
+fn bench_single(c: &mut Criterion) {
+    for (name, hash) in [("verus_hash_v1", verus_hash_v1 as fn(&[u8]) -> [u8; 32]), ("verus_hash_v2", verus_hash_v2)] {
+        let mut group = c.benchmark_group(name);
+        for_each_backend(|backend| {
+            for size in SIZES {
+                bench_inputs(&mut group, backend, &Inputs::new(size), hash);
+            }
+        });
+        group.finish();
+    }
+}
+
+// verus_hash_v2b regenerates its 8 KiB key whenever the seed changes, so
+// fixed inputs measure the cached key path and random ones a fresh key.
+fn bench_v2b(c: &mut Criterion) {
+    let mut group = c.benchmark_group("verus_hash_v2b");
+    for_each_backend(|backend| {
+        for size in SIZES {
+            let inputs = Inputs::new(size);
+            bench_inputs(&mut group, backend, &inputs, verus_hash_v2b);
+            let mut ctx = VerusHashContext::new().expect("context allocation");
+            bench_inputs(&mut group, &format!("{backend}/context"), &inputs, |data| ctx.hash(data));
+        }
+    });
+    group.finish();
+}
+
+fn bench_batch(c: &mut Criterion) {
+    type BatchFn = fn(&[u8], usize, &mut [[u8; 32]]);
+    for (name, batch) in [("hash_batch", hash_batch_into as BatchFn), ("hash_batch_v1", hash_batch_v1_into)] {
+        let mut group = c.benchmark_group(name);
+        let mut out = vec![[0u8; 32]; POOL];
+        for_each_backend(|backend| {
+            for size in SIZES {
+                let inputs = Inputs::new(size);
+                let fixed = inputs.fixed.repeat(POOL);
+                group.throughput(Throughput::Elements(POOL as u64));
+                group.bench_function(BenchmarkId::new(format!("{backend}/fixed"), size), |b| {
+                    b.iter(|| batch(black_box(&fixed), size, &mut out))
+                });
+                group.bench_function(BenchmarkId::new(format!("{backend}/random"), size), |b| {
+                    b.iter(|| batch(black_box(&inputs.pool), size, &mut out))
+                });
+            }
+        });
+        group.finish();
+    }
+}
+
+// a message of `size` bytes as a midstate over its whole leading blocks
+// plus a finish over the rest, as a miner hashing nonces behind a prefix
+fn bench_midstate(c: &mut Criterion) {
+    let mut group = c.benchmark_group("midstate_v2");
+    for_each_backend(|backend| {
+        for size in SIZES {
+            let inputs = Inputs::new(size);
+            let split = (size - 1) / 32 * 32;
+            let mid = VerusMidstate::v2(&inputs.fixed[..split]).expect("whole blocks");
+            bench_inputs(&mut group, backend, &inputs, |data| mid.finish(&data[split..]));
+        }
+    });
+    group.finish();
+}
+
+fn bench_hasher(c: &mut Criterion) {
+    let mut group = c.benchmark_group("hasher_v2");
+    for_each_backend(|backend| {
+        for size in SIZES {
+            bench_inputs(&mut group, backend, &Inputs::new(size), |data| VerusHasher::v2().update(data).finalize());
+        }
+    });
+    group.finish();
+}
+
+// a target no hash meets, so every scan runs through all its nonces
+fn bench_search(c: &mut Criterion) {
+    let mut group = c.benchmark_group("search_v2");
+    for_each_backend(|backend| {
+        for size in SIZES.into_iter().filter(|&size| size <= SEARCH_MAX_LEN) {
+            let inputs = Inputs::new(size);
+            let mut start = 0;
+            group.throughput(Throughput::Elements(SEARCH_NONCES));
+            for (input, template) in [("fixed", &inputs.fixed[..]), ("random", inputs.message(0))] {
+                group.bench_function(BenchmarkId::new(format!("{backend}/{input}"), size), |b| {
+                    b.iter(|| {
+                        start += SEARCH_NONCES;
+                        search_v2(black_box(template), size - 8, start..start + SEARCH_NONCES, &[0u8; 32]).next()
+                    })
+                });
+            }
+        }
+    });
+    group.finish();
+}
+
+fn bench_verify(c: &mut Criterion) {
+    let mut group = c.benchmark_group("verify_hash");
+    let target = difficulty_to_target(8);
+    for_each_backend(|backend| {
+        for size in SIZES {
+            bench_inputs(&mut group, backend, &Inputs::new(size), |data| verify_hash(data, &target));
+        }
+    });
+    group.finish();
+}
+
+// pure Rust and independent of message size: one fixed difficulty and a
+// sweep over all of them
+fn bench_difficulty(c: &mut Criterion) {
+    let mut group = c.benchmark_group("difficulty_to_target");
+    group.throughput(Throughput::Elements(1));
+    group.bench_function("fixed", |b| b.iter(|| difficulty_to_target(black_box(13))));
+    let mut difficulty = 0u64;
+    group.bench_function("random", |b| {
+        b.iter(|| {
+            difficulty = (difficulty + 37) % 257;
+            difficulty_to_target(black_box(difficulty))
+        })
+    });
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    bench_single,
+    bench_v2b,
+    bench_batch,
+    bench_midstate,
+    bench_hasher,
+    bench_search,
+    bench_verify,
+    bench_difficulty
+);
+
+fn main() {
+    let started = SystemTime::now();
+    benches();
+    Criterion::default().configure_from_args().final_summary();
+    if !baseline::run(started) {
+        std::process::exit(1);
+    }
+}
@@ -139,7 +139,7 @@ fn main() {
         .expect("Failed to write constants include file");
 
     // Also copy the generated constants file into the C source directory (`verus/c/`)
-    // so that `#include "haraka_rc_vrsc.inc"` in `haraka_portable.c` can find it
+    // so that `#include "haraka_rc_vrsc.inc"` in `haraka_portable.cpp` can find it
     // reliably during both host and SBF builds, without relying on OUT_DIR include paths.
     let constants_dest_path = crate_dir.join("c").join("haraka_rc_vrsc.inc");
     println!(
@@ -242,8 +242,25 @@ fn main() {
     // Add paths relative to CARGO_MANIFEST_DIR (verus crate root) using the 'c' directory
     println!("cargo:rerun-if-changed=c/verus_hash.cpp");
     println!("cargo:rerun-if-changed=c/verus_hash.h");
-    println!("cargo:rerun-if-changed=c/haraka_portable.c"); // Includes generated constants AND zero-key functions
+    println!("cargo:rerun-if-changed=c/haraka_portable.cpp"); // Includes generated constants AND zero-key functions
     println!("cargo:rerun-if-changed=c/haraka_portable.h"); // Includes declarations for zero-key functions
+    println!("cargo:rerun-if-changed=c/haraka_tmpl.h"); // Unrolled permutation templates
+    println!("cargo:rerun-if-changed=c/haraka_sbox.h"); // Shared S-box literal
+    println!("cargo:rerun-if-changed=c/haraka_bitslice.cpp"); // Bitsliced 8-way engine
+    println!("cargo:rerun-if-changed=c/haraka_x86.h"); // x86 host engine declarations
+    println!("cargo:rerun-if-changed=c/haraka_vperm.h"); // Vector-permute AES kernel
+    println!("cargo:rerun-if-changed=c/haraka_vperm_ssse3.cpp");
+    println!("cargo:rerun-if-changed=c/haraka_vperm_avx2.cpp");
+    println!("cargo:rerun-if-changed=c/haraka_gather_avx2.cpp"); // AVX2 gather T-table engine
+    println!("cargo:rerun-if-changed=c/haraka_dispatch.h"); // Runtime engine selection
+    println!("cargo:rerun-if-changed=c/haraka_dispatch.cpp");
+    println!("cargo:rerun-if-changed=c/clmul_pclmul.cpp"); // Hardware clmul_mix
+    println!("cargo:rerun-if-changed=c/verus_hash2b.h"); // Full VerusHash 2.2 (Finalize2b)
+    println!("cargo:rerun-if-changed=c/verus_hash2b.cpp");
+    println!("cargo:rerun-if-changed=c/verus_hash2b_tmpl.h");
+    println!("cargo:rerun-if-changed=c/verus_hash2b_aesni.cpp");
+    println!("cargo:rerun-if-changed=c/haraka_rc_std.inc");
+    println!("cargo:rerun-if-changed=c/sbox.inc");
     println!("cargo:rerun-if-changed=c/common.h");
     println!("cargo:rerun-if-changed=c/uint256.cpp");
     println!("cargo:rerun-if-changed=c/uint256.h");
@@ -259,4 +276,5 @@ fn main() {
     // correctly on all targets.
     // Rerun if feature flags change as well.
     println!("cargo:rerun-if-env-changed=CARGO_FEATURE_PORTABLE");
+    println!("cargo:rerun-if-env-changed=VERUS_AES_TABLES");
 }
@@ -36,7 +36,7 @@ if [[ ! -f "$COMMON_CPP" ]]; then
 #include "haraka_portable.h" // Use our header for memset/size_t
 
 // Provide a basic implementation if the original is missing.
-// Calls the verus_memset declared in haraka_portable.h (implemented in haraka_portable.c)
+// Calls the verus_memset declared in haraka_portable.h (implemented in haraka_portable.cpp)
 extern "C" void memory_cleanse(void* p, size_t n) {
     verus_memset(p, 0, n); // Use our custom memset
 }
@@ -49,13 +49,34 @@ fi
 # Use paths relative to the script's location (CRATE_DIR)
 # CRYPTO_SRC now points to verus/c/
 SRC_FILES=(
-  "$CRYPTO_SRC/haraka_portable.c" # Portable file (now includes generated constants)
+  "$CRYPTO_SRC/haraka_portable.cpp" # Portable file (now includes generated constants)
+  "$CRYPTO_SRC/haraka_bitslice.cpp"  # Bitsliced 8-way batch engine
   "$CRYPTO_SRC/verus_hash.cpp"
   "$CRYPTO_SRC/uint256.cpp"
   # common.cpp might be added later if stubbed
   # haraka_constants.c is no longer needed as source, constants are included
 )
 
+# Full VerusHash 2.2 (Finalize2b) keeps a 17 KiB key per thread, which SBF
+# has no room for; host builds only.
+if [[ "$TARGET" != *"bpf"* && "$TARGET" != *"sbf"* ]]; then
+  SRC_FILES+=("$CRYPTO_SRC/verus_hash2b.cpp")
+fi
+
+# x86 host engines (vector-permute AES, AVX2 gather, PCLMULQDQ); each file is built with its own
+# ISA flag (see step 4) and only runs where the CPU supports it, as picked by
+# cpuid in haraka_dispatch.cpp.  Never part of SBF builds.
+if [[ "$TARGET" == x86_64* || "$TARGET" == i686* ]]; then
+  SRC_FILES+=(
+    "$CRYPTO_SRC/haraka_dispatch.cpp"
+    "$CRYPTO_SRC/haraka_vperm_ssse3.cpp"
+    "$CRYPTO_SRC/haraka_vperm_avx2.cpp"
+    "$CRYPTO_SRC/haraka_gather_avx2.cpp"
+    "$CRYPTO_SRC/clmul_pclmul.cpp"
+    "$CRYPTO_SRC/verus_hash2b_aesni.cpp"
+  )
+fi
+
 # Filter out non-existent files to prevent build errors
 EXISTING_SRC_FILES=()
 for src in "${SRC_FILES[@]}"; do
@@ -74,7 +95,7 @@ fi
 # ------------------------------------------------------------------------------
 # Conditionally remove haraka_constants.c for SBF builds
 # ------------------------------------------------------------------------------
-# We embed the VRSC constants directly into haraka_portable.c via the included
+# We embed the VRSC constants directly into haraka_portable.cpp via the included
 # haraka_rc_vrsc.inc file. Compiling haraka_constants.c for SBF would lead
 # to linking the wrong (default AES) constants.
 if [[ "$TARGET" == *"bpf"* || "$TARGET" == *"sbf"* ]]; then
@@ -141,6 +162,11 @@ if [[ "$TARGET" == *"bpf"* || "$TARGET" == *"sbf"* ]]; then
   # Add portable flag
   CFLAGS="$CFLAGS -DVERUSHASH_PORTABLE=1"
   CXXFLAGS="$CXXFLAGS -DVERUSHASH_PORTABLE=1"
+  # 64-bit packed-pair Haraka kernel (also the default for __bpf__),
+  # unless a low-footprint table layout was requested (see below)
+  if [[ "${VERUS_AES_TABLES:-4}" == "4" ]]; then
+    CXXFLAGS="$CXXFLAGS -DHARAKA_PACKED64=1"
+  fi
   # Disable builtins
   CFLAGS="$CFLAGS -fno-builtin-memcpy -fno-builtin-memset"
   CXXFLAGS="$CXXFLAGS -fno-builtin-memcpy -fno-builtin-memset"
@@ -170,6 +196,16 @@ else
   CXXFLAGS="$CXXFLAGS -DVERUSHASH_PORTABLE=1"
 fi
 
+# AES table layout of the portable Haraka (haraka_portable.cpp):
+#   VERUS_AES_TABLES=4  four 1 KiB T-tables (default; SBF uses the packed
+#                       64-bit kernel with its own 16 KiB tables)
+#   VERUS_AES_TABLES=1  one 1 KiB T-table + rotations
+#   VERUS_AES_TABLES=0  256-byte S-box, MixColumns computed
+if [[ -n "${VERUS_AES_TABLES:-}" ]]; then
+  echo "build.sh: Using AES table layout $VERUS_AES_TABLES"
+  CXXFLAGS="$CXXFLAGS -DHARAKA_AES_TABLES=$VERUS_AES_TABLES"
+fi
+
 # ------------------------------------------------------------------------------
 # 4. Compile every .c / .cpp -> object file
 # ------------------------------------------------------------------------------
@@ -180,9 +216,17 @@ for src in "${EXISTING_SRC_FILES[@]}"; do
   obj="$OUT_DIR/$(basename "${src%.*}").o"
   OBJ_FILES+=("$obj")
   echo "Compiling $src -> $obj"
+  # per-file ISA flags for the x86 host engines
+  ISA_FLAGS=""
+  case "$src" in
+  *_ssse3.cpp) ISA_FLAGS="-mssse3" ;;
+  *_avx2.cpp) ISA_FLAGS="-mavx2" ;;
+  *_pclmul.cpp) ISA_FLAGS="-mpclmul -msse2" ;;
+  *_aesni.cpp) ISA_FLAGS="-maes -mpclmul -mssse3" ;;
+  esac
   case "$src" in
-  *.c) $CC $CFLAGS -c "$src" -o "$obj" || exit 1 ;;
-  *.cpp) $CXX $CXXFLAGS -c "$src" -o "$obj" || exit 1 ;;
+  *.c) $CC $CFLAGS $ISA_FLAGS -c "$src" -o "$obj" || exit 1 ;;
+  *.cpp) $CXX $CXXFLAGS $ISA_FLAGS -c "$src" -o "$obj" || exit 1 ;;
   esac
 done
 echo "-------------------------------------------"
@@ -0,0 +1,281 @@
+/*--------------------------------------------------------------------
+ * bench_counters.cpp  –  hardware counters per primitive
+ *
+ *   Runs the building blocks of verus_hash() / verus_hash_v2_2() one
+ *   at a time and reads the CPU's counters around each through
+ *   perf_event_open: cycles, instructions, IPC, L1D read misses and
+ *   branch misses per call, next to the wall time.  Counters show why a
+ *   kernel is slow (T-table misses, verus_memcpy byte loops, data
+ *   dependent branches), not just that it is.  Not part of
+ *   libverushash; build it next to the library sources, e.g.
+ *
+ *     cd verus/c && C="g++ -std=c++17 -O3 -DVERUSHASH_PORTABLE=1 -I."
+ *     $C -c verus_hash.cpp haraka_dispatch.cpp haraka_portable.cpp \
+ *           haraka_bitslice.cpp
+ *     $C -mssse3 -c haraka_vperm_ssse3.cpp
+ *     $C -mavx2 -c haraka_vperm_avx2.cpp haraka_gather_avx2.cpp
+ *     $C -mpclmul -msse2 -c clmul_pclmul.cpp
+ *     $C bench_counters.cpp *.o -o bench_counters && ./bench_counters
+ *
+ *   Counters are user space only; they need perf_event_paranoid <= 2
+ *   (the default) and a PMU the kernel exposes, which many VMs do not.
+ *   Without one every counter column reads n/a and only the time is
+ *   measured.  Each row is the run with the fewest cycles (fastest,
+ *   without counters) of many short runs, as in bench_haraka.cpp.
+ *
+ *   aesenc is one round of the portable engine's default four T-table
+ *   kernel (HARAKA_AES_TABLES=4), which the library keeps static; it is
+ *   rebuilt here from the same haraka_sbox.h tables.
+ *------------------------------------------------------------------*/
+#include "verus_hash.h"
+#include "haraka_portable.h"
+#include "haraka_dispatch.h"
+#include "haraka_sbox.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+/*---------------- perf_event_open group ----------------------------*/
+enum { CYCLES, INSTRUCTIONS, L1D_MISSES, BRANCH_MISSES, NCOUNTERS };
+
+static const char *const counter_names[NCOUNTERS] = {
+    "cycles", "instructions", "L1D read misses", "branch misses"
+};
+
+/* one group led by cycles; a counter the CPU lacks is left out and its
+   column reads n/a */
+struct Counters {
+    int fd[NCOUNTERS];
+    int slot[NCOUNTERS];     /* index in the group read, -1 if absent */
+    int open;
+
+    Counters() : open(0)
+    {
+        for (int c = 0; c < NCOUNTERS; ++c)
+            fd[c] = slot[c] = -1;
+#ifdef __linux__
+        static const uint32_t type[NCOUNTERS] = {
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE
+        };
+        static const uint64_t config[NCOUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_BRANCH_MISSES
+        };
+
+        for (int c = 0; c < NCOUNTERS; ++c) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof attr);
+            attr.size = sizeof attr;
+            attr.type = type[c];
+            attr.config = config[c];
+            attr.disabled = c == CYCLES;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            fd[c] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, fd[CYCLES], 0);
+            if (fd[c] < 0) {
+                std::printf("perf_event_open(%s): %s\n", counter_names[c], std::strerror(errno));
+                if (c == CYCLES)
+                    return;
+                continue;
+            }
+            slot[c] = open++;
+        }
+#endif
+    }
+
+    ~Counters()
+    {
+#ifdef __linux__
+        for (int c = 0; c < NCOUNTERS; ++c)
+            if (fd[c] >= 0)
+                close(fd[c]);
+#endif
+    }
+
+    void start()
+    {
+#ifdef __linux__
+        if (open) {
+            ioctl(fd[CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fd[CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    /* counts since start(), scaled up if the group was multiplexed;
+       false without counters */
+    bool stop(double out[NCOUNTERS])
+    {
+#ifdef __linux__
+        uint64_t buf[3 + NCOUNTERS];
+
+        if (!open)
+            return false;
+        ioctl(fd[CYCLES], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        if (read(fd[CYCLES], buf, sizeof buf) < (ssize_t)((3 + open) * sizeof(uint64_t)) || !buf[2])
+            return false;
+        const double scale = (double)buf[1] / (double)buf[2];
+        for (int c = 0; c < NCOUNTERS; ++c)
+            out[c] = slot[c] < 0 ? -1 : (double)buf[3 + slot[c]] * scale;
+        return true;
+#else
+        (void)out;
+        return false;
+#endif
+    }
+};
+
+static Counters counters;
+
+/*---------------- measurement -------------------------------------*/
+static uint8_t msg[1487];
+static uint8_t out[64];
+static volatile uint64_t sink;
+
+/* per call: ns and the counters of the best of `runs` runs of `calls`
+   calls; msg[0] changes every call, so nothing can be hoisted */
+template <class F>
+static void measure(const char *name, unsigned calls, F f)
+{
+    const unsigned runs = 200;
+    double best_ns = 1e30, best[NCOUNTERS];
+    bool have = false;
+
+    for (unsigned r = 0; r < runs; ++r) {
+        double c[NCOUNTERS];
+
+        counters.start();
+        const auto t0 = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < calls; ++i) {
+            msg[0] = (uint8_t)(msg[0] + out[i % 32] + 1);
+            f();
+        }
+        const std::chrono::duration<double, std::nano> d =
+            std::chrono::steady_clock::now() - t0;
+        const bool counted = counters.stop(c);
+
+        if (counted ? !have || c[CYCLES] < best[CYCLES] : d.count() < best_ns) {
+            best_ns = d.count();
+            if (counted)
+                std::memcpy(best, c, sizeof best);
+            have = counted;
+        }
+    }
+
+    std::printf("%-32s %9.1f", name, best_ns / calls);
+    if (!have) {
+        std::printf(" %10s %10s %6s %10s %10s\n", "n/a", "n/a", "n/a", "n/a", "n/a");
+        return;
+    }
+    for (int c = 0; c < NCOUNTERS; ++c) {
+        if (best[c] < 0)
+            std::printf(" %10s", "n/a");
+        else
+            std::printf(" %10.1f", best[c] / calls);
+        if (c == INSTRUCTIONS) {
+            if (best[CYCLES] > 0 && best[INSTRUCTIONS] >= 0)
+                std::printf(" %6.2f", best[INSTRUCTIONS] / best[CYCLES]);
+            else
+                std::printf(" %6s", "n/a");
+        }
+    }
+    std::printf("\n");
+}
+
+/*---------------- aesenc: one T-table round -----------------------*/
+static const uint32_t T[4][256] = { SBOX(U0), SBOX(U1), SBOX(U2), SBOX(U3) };
+
+static inline void aesenc(uint32_t c[4], const uint32_t k[4])
+{
+    const uint32_t x0 = c[0], x1 = c[1], x2 = c[2], x3 = c[3];
+
+    c[0] = T[0][x0 & 0xff] ^ T[1][(x1 >> 8) & 0xff] ^ T[2][(x2 >> 16) & 0xff] ^ T[3][x3 >> 24] ^ k[0];
+    c[1] = T[0][x1 & 0xff] ^ T[1][(x2 >> 8) & 0xff] ^ T[2][(x3 >> 16) & 0xff] ^ T[3][x0 >> 24] ^ k[1];
+    c[2] = T[0][x2 & 0xff] ^ T[1][(x3 >> 8) & 0xff] ^ T[2][(x0 >> 16) & 0xff] ^ T[3][x1 >> 24] ^ k[2];
+    c[3] = T[0][x3 & 0xff] ^ T[1][(x0 >> 8) & 0xff] ^ T[2][(x1 >> 16) & 0xff] ^ T[3][x2 >> 24] ^ k[3];
+}
+
+static const char *level_name(int level)
+{
+    static const char *const names[] = { "portable", "ssse3", "avx2" };
+    return level >= 0 && level < 3 ? names[level] : "?";
+}
+
+int main()
+{
+    for (size_t i = 0; i < sizeof msg; ++i)
+        msg[i] = (uint8_t)(i * 7 + 1);
+
+    std::printf("\n%-32s %9s %10s %10s %6s %10s %10s\n", "per call", "ns",
+                "cycles", "instr", "IPC", "L1D miss", "br miss");
+
+    uint32_t state[4] = { 1, 2, 3, 4 }, key[4] = { 5, 6, 7, 8 };
+    measure("aesenc (T-table round)", 4096, [&] {
+        key[0] = msg[0];
+        aesenc(state, key);
+        out[0] = (uint8_t)state[0];
+    });
+    measure("haraka512_perm_zero", 256, [] { haraka512_perm_zero(out, msg); });
+    measure("haraka512_port_zero", 256, [] { haraka512_port_zero(out, msg); });
+    measure("haraka256_port", 256, [] { haraka256_port(out, msg); });
+    measure("clmul_mix", 4096, [] {
+        uint64_t a;
+        std::memcpy(&a, msg, 8);
+        sink += clmul_mix(a, a ^ sink);
+        out[0] = (uint8_t)sink;
+    });
+#if HARAKA_DISPATCH
+    ForceCPUHarakaOptimized(-1);
+    measure("clmul_mix_fn", 4096, [] {
+        uint64_t a;
+        std::memcpy(&a, msg, 8);
+        sink += clmul_mix_fn(a, a ^ sink);
+        out[0] = (uint8_t)sink;
+    });
+#endif
+    measure("verus_memcpy (64 B)", 4096, [] { verus_memcpy(out, msg, 64); });
+
+    /* the whole hashes at every Haraka engine level this CPU has */
+    int levels[3], nlevels = 0;
+#if HARAKA_DISPATCH
+    for (int level = 0; level <= 2; ++level) {
+        ForceCPUHarakaOptimized(level);
+        if (IsCPUHarakaOptimized() == level)
+            levels[nlevels++] = level;
+    }
+#else
+    levels[nlevels++] = 0;
+#endif
+    for (int i = 0; i < nlevels; ++i) {
+        char name[64];
+
+#if HARAKA_DISPATCH
+        ForceCPUHarakaOptimized(levels[i]);
+#endif
+        std::snprintf(name, sizeof name, "verus_hash 80 B [%s]", level_name(levels[i]));
+        measure(name, 64, [] { verus_hash(out, msg, 80); });
+        std::snprintf(name, sizeof name, "verus_hash_v2_2 80 B [%s]", level_name(levels[i]));
+        measure(name, 64, [] { verus_hash_v2_2(out, msg, 80); });
+        std::snprintf(name, sizeof name, "verus_hash_v2_2 1487 B [%s]", level_name(levels[i]));
+        measure(name, 4, [] { verus_hash_v2_2(out, msg, 1487); });
+    }
+#if HARAKA_DISPATCH
+    ForceCPUHarakaOptimized(-1);
+#endif
+    return 0;
+}
@@ -0,0 +1,84 @@
+/*--------------------------------------------------------------------
+ * bench_haraka.cpp  –  host benchmark of the Haraka engines
+ *
+ *   Times every engine that produces haraka512_port / haraka256_port
+ *   output on this CPU and prints ns per hash, so the fastest
+ *   non-AES-NI engine can be picked per microarchitecture.  Not part
+ *   of libverushash; build it next to the library sources, e.g.
+ *
+ *     cd verus/c && C="g++ -std=c++17 -O3 -DVERUSHASH_PORTABLE=1 -I."
+ *     $C -c haraka_portable.cpp haraka_bitslice.cpp
+ *     $C -mssse3 -c haraka_vperm_ssse3.cpp
+ *     $C -mavx2 -c haraka_vperm_avx2.cpp haraka_gather_avx2.cpp
+ *     $C bench_haraka.cpp *.o -o bench_haraka && ./bench_haraka
+ *
+ *   Each figure is the best of many short runs, which is stable on
+ *   shared / noisy hosts where a single long run is not.
+ *------------------------------------------------------------------*/
+#include "haraka_portable.h"
+#include "haraka_x86.h"
+
+#include <chrono>
+#include <cstdio>
+
+typedef void (*HarakaFn)(uint8_t *out, const uint8_t *in);
+
+struct Engine {
+    const char *name;
+    HarakaFn    h512;
+    HarakaFn    h256;
+    unsigned    states;   /* hashes per call */
+    bool        usable;
+};
+
+/* best-of-runs time per hash; the first input byte changes each call so
+   nothing can be hoisted */
+static double ns_per_hash(HarakaFn f, unsigned states)
+{
+    static uint8_t in[8 * 64], out[8 * 32];
+    const unsigned calls = 64, runs = 400;
+    double best = 1e30;
+
+    for (unsigned r = 0; r < runs; ++r) {
+        const auto t0 = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < calls; ++i) {
+            in[0] = (uint8_t)(in[0] + out[i % 32]);
+            f(out, in);
+        }
+        const std::chrono::duration<double, std::nano> d =
+            std::chrono::steady_clock::now() - t0;
+        if (d.count() < best)
+            best = d.count();
+    }
+    return best / (calls * states);
+}
+
+int main()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    const bool ssse3 = __builtin_cpu_supports("ssse3");
+    const bool avx2  = __builtin_cpu_supports("avx2");
+#endif
+    const Engine engines[] = {
+        { "scalar (T-table)",    haraka512_port,      haraka256_port,      1, true  },
+        { "x4 (T-table)",        haraka512_port_x4,   haraka256_port_x4,   4, true  },
+        { "bitsliced x8",        haraka512_port_bs8,  haraka256_port_bs8,  8, true  },
+#if defined(__x86_64__) || defined(__i386__)
+        { "vperm SSSE3",         haraka512_vperm,     haraka256_vperm,     1, ssse3 },
+        { "vperm AVX2 x2",       haraka512_vperm_x2,  haraka256_vperm_x2,  2, avx2  },
+        { "gather AVX2 x8",      haraka512_gather_x8, haraka256_gather_x8, 8, avx2  },
+#endif
+    };
+
+    std::printf("%-20s %14s %14s\n", "engine", "haraka512 ns", "haraka256 ns");
+    for (const Engine &e : engines) {
+        if (!e.usable) {
+            std::printf("%-20s %14s %14s\n", e.name, "n/a", "n/a");
+            continue;
+        }
+        std::printf("%-20s %14.1f %14.1f\n", e.name,
+                    ns_per_hash(e.h512, e.states), ns_per_hash(e.h256, e.states));
+    }
+    return 0;
+}
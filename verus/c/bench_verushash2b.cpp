@@ -0,0 +1,119 @@
+/*--------------------------------------------------------------------
+ * bench_verushash2b.cpp  –  per-stage host benchmark of full
+ *                           VerusHash 2.2 (verus_hash2b.h)
+ *
+ *   Times each stage of every engine usable on this CPU (sponge over
+ *   an 80- and a 1487-byte message, key generation, CLHASH, keyed
+ *   final) and the whole hash with a new seed per call and with a
+ *   repeated seed (cached key).  Not part of libverushash; build it
+ *   next to the library sources, e.g.
+ *
+ *     cd verus/c && C="g++ -std=c++17 -O3 -DVERUSHASH_PORTABLE=1 -I."
+ *     $C -c verus_hash2b.cpp haraka_dispatch.cpp haraka_portable.cpp \
+ *           haraka_bitslice.cpp
+ *     $C -maes -mpclmul -mssse3 -c verus_hash2b_aesni.cpp
+ *     $C -mssse3 -c haraka_vperm_ssse3.cpp
+ *     $C -mavx2 -c haraka_vperm_avx2.cpp haraka_gather_avx2.cpp
+ *     $C -mpclmul -msse2 -c clmul_pclmul.cpp
+ *     $C bench_verushash2b.cpp *.o -o bench_verushash2b && ./bench_verushash2b
+ *
+ *   Each figure is the best of many short runs (see bench_haraka.cpp).
+ *------------------------------------------------------------------*/
+#include "verus_hash2b.h"
+#include "haraka_dispatch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+static uint8_t msg[1487];
+alignas(32) static uint8_t key[VERUS_V2B_KEY_SIZE];
+alignas(16) static uint8_t block[64];
+static uint8_t out[32];
+static uint16_t moved[64];
+static volatile uint64_t sink;
+
+/* best-of-runs ns per call of f(); msg[0] changes every call, so
+   nothing can be hoisted */
+template <class F>
+static double ns_per_call(F f, unsigned calls)
+{
+    const unsigned runs = 200;
+    double best = 1e30;
+
+    for (unsigned r = 0; r < runs; ++r) {
+        const auto t0 = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < calls; ++i) {
+            msg[0] = (uint8_t)(msg[0] + out[i % 32] + 1);
+            f();
+        }
+        const std::chrono::duration<double, std::nano> d =
+            std::chrono::steady_clock::now() - t0;
+        if (d.count() < best)
+            best = d.count();
+    }
+    return best / calls;
+}
+
+static void bench(const verus_v2b_engine *e)
+{
+    for (size_t i = 0; i < sizeof msg; ++i)
+        msg[i] = (uint8_t)(i * 7 + 1);
+    e->sponge(block, msg, 80);
+    e->keygen(key, block);
+
+    const double sponge80 = ns_per_call([&] { sink += e->sponge(block, msg, 80); }, 64);
+    const double sponge1487 = ns_per_call([&] { sink += e->sponge(block, msg, 1487); }, 4);
+    const double keygen = ns_per_call([&] { block[0] = msg[0]; e->keygen(key, block); }, 8);
+    const double clhash = ns_per_call([&] {
+        block[32] = msg[0];
+        sink += e->clhash(key, block, moved);
+    }, 64);
+    const double keyed = ns_per_call([&] {
+        block[32] = msg[0];
+        e->keyed(out, block, 16, key, sink++);
+    }, 64);
+
+    std::printf("%-10s %9.1f %10.1f %9.1f %9.1f %9.1f\n", e->name,
+                sponge80, sponge1487, keygen, clhash, keyed);
+}
+
+/* whole hash through verus_hash_v2b(): the 80-byte message changes in
+   the first block (new seed, key regenerated) or in the last, partial
+   block (same seed, cached key) */
+static void bench_full(const char *name)
+{
+    const double fresh = ns_per_call([] {
+        msg[1] = msg[0];
+        verus_hash_v2b(out, msg, 80);
+    }, 16);
+    const double cached = ns_per_call([] {
+        msg[70] = msg[0];
+        msg[0] = 1;
+        verus_hash_v2b(out, msg, 80);
+    }, 64);
+
+    std::printf("%-10s %14.1f %14.1f\n", name, fresh, cached);
+}
+
+int main()
+{
+    std::printf("stage ns      sponge80 sponge1487    keygen    clhash     keyed\n");
+    bench(&verus_v2b_port);
+#if HARAKA_DISPATCH
+    ForceCPUHarakaOptimized(-1);
+    if (IsCPUVerusOptimized())
+        bench(&verus_v2b_aesni);
+    else
+        std::printf("%-10s n/a\n", verus_v2b_aesni.name);
+#endif
+
+    std::printf("\nfull ns (80 B)  new seed    cached key\n");
+#if HARAKA_DISPATCH
+    ForceCPUHarakaOptimized(0);
+    bench_full(verus_v2b_engine_get()->name);
+    ForceCPUHarakaOptimized(-1);
+#endif
+    bench_full(verus_v2b_engine_get()->name);
+    return 0;
+}
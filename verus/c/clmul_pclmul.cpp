@@ -0,0 +1,21 @@
+/*--------------------------------------------------------------------
+ * clmul_pclmul.cpp  –  clmul_mix with PCLMULQDQ
+ *
+ *   Built with -mpclmul on x86 hosts only (see build.sh) and reached
+ *   through clmul_mix_fn once cpuid reports PCLMULQDQ.  Returns the
+ *   same low 64 bits as the portable clmul_mix().
+ *------------------------------------------------------------------*/
+#include "verus_clhash.h"
+
+#include <emmintrin.h>
+#include <wmmintrin.h>
+
+uint64_t clmul_mix_pclmul(uint64_t a, uint64_t b)
+{
+    const __m128i p = _mm_clmulepi64_si128(_mm_set_epi64x(0, (long long)a),
+                                           _mm_set_epi64x(0, (long long)b), 0x00);
+    uint64_t lo;
+
+    _mm_storel_epi64((__m128i *)&lo, p);
+    return lo;
+}
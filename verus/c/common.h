@@ -11,7 +11,7 @@ static inline uint32_t rotr32(uint32_t x, int n) { return (x >> n) | (x << (32 -
 /* -------- Provide standard function declarations needed for SBF -------- */
 
 // No standard memcpy declaration here to avoid conflicts.
-// We use a macro in haraka_portable.c to redirect calls internally.
+// We use a macro in haraka_portable.cpp to redirect calls internally.
 
 #endif /* VERUS_COMMON_H */
 
@@ -0,0 +1,430 @@
+/*--------------------------------------------------------------------
+ * haraka_bitslice.cpp  –  bitsliced 8-way portable Haraka
+ *
+ *   Runs eight independent Haraka states at once in 64-bit words with
+ *   no table lookups (constant time, no cache-port pressure).  Results
+ *   are byte-identical to haraka512_port / haraka512_port_zero /
+ *   haraka256_port.
+ *
+ *   Layout: every 128-bit AES block of the 8 states is 2 words x 8 bit
+ *   planes.  Word w holds AES rows 2w (low half) and 2w+1 (high half);
+ *   inside a row, column c of state s is bit 8*c + s.  Plane k holds
+ *   bit k of every byte.  With rows grouped per word ShiftRows is a
+ *   rotation inside 32-bit halves and MixColumns' row rotation is a
+ *   half-word swap.
+ *------------------------------------------------------------------*/
+#include "haraka_portable.h"
+#include "haraka_tmpl.h"
+#include "haraka_sbox.h"
+
+#if defined(__clang__) && defined(__ELF__)
+#  pragma clang section data   = ".data"
+#  pragma clang section rodata = ".rodata"
+#endif
+
+namespace {
+
+/*──────────────── word vectors ───────────────────────────────────*/
+/* N bitsliced words processed together; every gate is a loop over N,
+   which the host compilers turn into SSE2/AVX2 vector operations. */
+template <unsigned N>
+struct Words {
+    uint64_t v[N];
+};
+
+#define BS_OP(op)                                                        \
+    template <unsigned N>                                                \
+    static HARAKA_INLINE Words<N> operator op(const Words<N> &a,         \
+                                              const Words<N> &b)         \
+    {                                                                    \
+        Words<N> r;                                                      \
+        for (unsigned i = 0; i < N; ++i)                                 \
+            r.v[i] = a.v[i] op b.v[i];                                   \
+        return r;                                                        \
+    }
+BS_OP(&)
+BS_OP(|)
+BS_OP(^)
+#undef BS_OP
+
+template <unsigned N>
+static HARAKA_INLINE Words<N> operator~(const Words<N> &a)
+{
+    Words<N> r;
+    for (unsigned i = 0; i < N; ++i)
+        r.v[i] = ~a.v[i];
+    return r;
+}
+
+/*──────────────── S-box as a boolean circuit ─────────────────────*/
+#define BS_SB(p)   (p)
+static constexpr uint8_t kSbox[256] = SBOX(BS_SB);
+
+/* first input I >= from of group G whose S-box output has bit B set */
+constexpr unsigned next_set(unsigned g, unsigned b, unsigned from)
+{
+    return from == 8 ? 8
+         : ((kSbox[8*g + from] >> b) & 1) ? from : next_set(g, b, from + 1);
+}
+
+/* OR of the low-bit minterms m[I..7] whose S-box output has bit B set */
+template <unsigned G, unsigned B, unsigned I, class W>
+static HARAKA_INLINE W sbox_or(const W *m)
+{
+    constexpr unsigned nx = next_set(G, B, I + 1);
+    if constexpr (nx == 8)
+        return m[I];
+    else
+        return m[I] | sbox_or<G, B, nx>(m);
+}
+
+/* inputs whose bits 3..7 equal G */
+template <unsigned G, class W>
+static HARAKA_INLINE W group_term(const W *x, const W *n)
+{
+    return ((G & 16) ? x[7] : n[7]) & ((G & 8) ? x[6] : n[6]) &
+           ((G & 4)  ? x[5] : n[5]) & ((G & 2) ? x[4] : n[4]) &
+           ((G & 1)  ? x[3] : n[3]);
+}
+
+template <unsigned G, unsigned B, class W>
+static HARAKA_INLINE void sbox_bit(W *o, bool *set, const W *m, const W &g)
+{
+    constexpr unsigned first = next_set(G, B, 0);
+    if constexpr (first < 8) {
+        const W t = g & sbox_or<G, B, first>(m);
+        o[B] = set[B] ? o[B] | t : t;
+        set[B] = true;
+    }
+    if constexpr (B < 7)
+        sbox_bit<G, B + 1>(o, set, m, g);
+}
+
+/* minterm decoder: only groups holding a non-zero entry cost gates */
+template <unsigned G, class W>
+static HARAKA_INLINE void sbox_groups(W *o, bool *set, const W *m,
+                                      const W *x, const W *n)
+{
+    constexpr bool live = next_set(G, 0, 0) < 8 || next_set(G, 1, 0) < 8 ||
+                          next_set(G, 2, 0) < 8 || next_set(G, 3, 0) < 8 ||
+                          next_set(G, 4, 0) < 8 || next_set(G, 5, 0) < 8 ||
+                          next_set(G, 6, 0) < 8 || next_set(G, 7, 0) < 8;
+    if constexpr (live)
+        sbox_bit<G, 0>(o, set, m, group_term<G>(x, n));
+    if constexpr (G < 31)
+        sbox_groups<G + 1>(o, set, m, x, n);
+}
+
+/* words per S-box evaluation (see bs_aes) */
+static constexpr unsigned kSboxSlice = 2;
+
+/* SubBytes on planes x[0..7] */
+template <class W>
+static HARAKA_INLINE void bs_sbox(W *x)
+{
+    W n[8], m[8], o[8];
+    bool set[8] = { false, false, false, false, false, false, false, false };
+
+    for (unsigned k = 0; k < 8; ++k)
+        n[k] = ~x[k];
+    const W m00 = n[0] & n[1], m01 = x[0] & n[1];
+    const W m10 = n[0] & x[1], m11 = x[0] & x[1];
+    m[0] = m00 & n[2]; m[1] = m01 & n[2]; m[2] = m10 & n[2]; m[3] = m11 & n[2];
+    m[4] = m00 & x[2]; m[5] = m01 & x[2]; m[6] = m10 & x[2]; m[7] = m11 & x[2];
+
+    sbox_groups<0>(o, set, m, x, n);
+    for (unsigned k = 0; k < 8; ++k)
+        x[k] = set[k] ? o[k] : x[k] & n[k];   /* never-set bit: constant 0 */
+}
+
+/*──────────────── state ──────────────────────────────────────────*/
+/* p[k].v[w*Blocks + b] = plane k of word w of block b */
+template <unsigned Blocks>
+struct State {
+    Words<2 * Blocks> p[8];
+};
+
+/*──────────────── bitsliced round keys ───────────────────────────*/
+/* Key planes of every AES layer (round r, step j) of variant V: 0xff in
+   every state lane whose key bit is set (same key for all 8 states). */
+template <class V>
+struct KeyPlanes {
+    uint64_t v[V::rounds * V::aes][8][2 * V::blocks];
+
+    constexpr KeyPlanes() : v()
+    {
+        for (unsigned r = 0; r < V::rounds; ++r)
+            for (unsigned j = 0; j < V::aes; ++j)
+                for (unsigned b = 0; b < V::blocks; ++b) {
+                    const unsigned i = V::rc_index(r, j, b);
+                    for (unsigned k = 0; k < 8; ++k)
+                        for (unsigned w = 0; w < 2; ++w)
+                            for (unsigned h = 0; h < 2; ++h)
+                                for (unsigned c = 0; c < 4; ++c)
+                                    if ((haraka::kRC[i][4*c + 2*w + h] >> k) & 1)
+                                        v[r*V::aes + j][k][w*V::blocks + b] |=
+                                            0xffULL << (32*h + 8*c);
+                }
+    }
+};
+
+template <class V>
+struct Keys {
+    static constexpr KeyPlanes<V> planes = KeyPlanes<V>();
+};
+template <class V>
+constexpr KeyPlanes<V> Keys<V>::planes;
+
+/*──────────────── AES layer ──────────────────────────────────────*/
+/* One AES round (SubBytes, ShiftRows, MixColumns, optional AddRoundKey)
+   on every block at once. */
+template <class V>
+static void bs_aes(State<V::blocks> &st, unsigned layer)
+{
+    constexpr unsigned B = V::blocks;
+    Words<2 * B> t[8], u[8];
+
+    /* SubBytes one 128-bit slice at a time: the circuit then fits the
+       register file instead of spilling every gate of all 2*B words */
+    for (unsigned i = 0; i < 2 * B; i += kSboxSlice) {
+        Words<kSboxSlice> x[8];
+        for (unsigned k = 0; k < 8; ++k)
+            for (unsigned c = 0; c < kSboxSlice; ++c)
+                x[k].v[c] = st.p[k].v[i + c];
+        bs_sbox(x);
+        for (unsigned k = 0; k < 8; ++k)
+            for (unsigned c = 0; c < kSboxSlice; ++c)
+                st.p[k].v[i + c] = x[k].v[c];
+    }
+
+    for (unsigned k = 0; k < 8; ++k) {
+        for (unsigned b = 0; b < B; ++b) {
+            uint64_t lo = st.p[k].v[b], hi = st.p[k].v[B + b];
+
+            /* ShiftRows: row r rotates left by r columns, i.e. the row's
+               32-bit field rotates right by 8*r bits */
+            lo = (lo & 0x00000000ffffffffULL)         |
+                 ((lo >> 8)  & 0x00ffffff00000000ULL) |
+                 ((lo << 24) & 0xff00000000000000ULL);
+            hi = ((hi >> 16) & 0x000000000000ffffULL) |
+                 ((hi << 16) & 0x00000000ffff0000ULL) |
+                 ((hi << 8)  & 0xffffff0000000000ULL) |
+                 ((hi >> 24) & 0x000000ff00000000ULL);
+
+            /* MixColumns: out_i = 2a_i ^ 3a_(i+1) ^ a_(i+2) ^ a_(i+3) with
+               rows a0 a1 | a2 a3.  rot1 = (a1 a2 | a3 a0), rot2 = (hi | lo),
+               rot3 = (rot1.hi | rot1.lo); t = a ^ rot1, u = rot1^rot2^rot3 */
+            const uint64_t r1lo = (lo >> 32) | (hi << 32);
+            const uint64_t r1hi = (hi >> 32) | (lo << 32);
+            const uint64_t v    = r1lo ^ r1hi;
+
+            t[k].v[b]     = lo ^ r1lo;
+            t[k].v[B + b] = hi ^ r1hi;
+            u[k].v[b]     = v ^ hi;
+            u[k].v[B + b] = v ^ lo;
+        }
+    }
+
+    /* out = xtime(t) ^ u, xtime across planes: x^8 = x^4 + x^3 + x + 1 */
+    st.p[0] = u[0] ^ t[7];
+    st.p[1] = u[1] ^ t[0] ^ t[7];
+    st.p[2] = u[2] ^ t[1];
+    st.p[3] = u[3] ^ t[2] ^ t[7];
+    st.p[4] = u[4] ^ t[3] ^ t[7];
+    st.p[5] = u[5] ^ t[4];
+    st.p[6] = u[6] ^ t[5];
+    st.p[7] = u[7] ^ t[6];
+
+    if (V::keyed)
+        for (unsigned k = 0; k < 8; ++k)
+            for (unsigned i = 0; i < 2 * B; ++i)
+                st.p[k].v[i] ^= Keys<V>::planes.v[layer][k][i];
+}
+
+/* MIX4 / MIX2 on 32-bit lanes = AES columns: new column j of block X is
+   old column c of block Y (haraka::mix_src), moved inside both halves. */
+template <unsigned Blocks>
+static void bs_mix(State<Blocks> &st)
+{
+    for (unsigned k = 0; k < 8; ++k) {
+        const Words<2 * Blocks> old = st.p[k];
+
+        for (unsigned w = 0; w < 2; ++w)
+            for (unsigned x = 0; x < Blocks; ++x) {
+                uint64_t acc = 0;
+                for (unsigned j = 0; j < 4; ++j) {
+                    const unsigned src = haraka::mix_src(Blocks, 4*x + j);
+                    const unsigned y = src / 4, c = src % 4;
+                    const uint64_t v = old.v[w*Blocks + y];
+                    const uint64_t mask = 0x000000ff000000ffULL << (8*j);
+
+                    acc |= (j >= c ? v << (8*(j - c)) : v >> (8*(c - j))) & mask;
+                }
+                st.p[k].v[w*Blocks + x] = acc;
+            }
+    }
+}
+
+/*──────────────── pack / unpack (8 states <-> bit planes) ────────*/
+static inline uint64_t load64(const uint8_t *p)
+{
+    uint64_t v = 0;
+    for (unsigned i = 0; i < 8; ++i)
+        v |= (uint64_t)p[i] << (8*i);
+    return v;
+}
+static inline void store64(uint8_t *p, uint64_t v)
+{
+    for (unsigned i = 0; i < 8; ++i)
+        p[i] = (uint8_t)(v >> (8*i));
+}
+
+/* 4x4 byte transpose of a block: memory order (column-major, A = cols
+   0,1, B = cols 2,3) <-> row-major (A = rows 0,1, B = rows 2,3).  It is
+   an involution, so it serves both directions. */
+static HARAKA_INLINE void transpose4x4(uint64_t &a, uint64_t &b)
+{
+    uint64_t t = ((a >> 16) ^ b) & 0x0000ffff0000ffffULL;
+    b ^= t;
+    a ^= t << 16;
+    t = (a ^ (a >> 24)) & 0x00000000ff00ff00ULL;
+    a ^= t ^ (t << 24);
+    t = (b ^ (b >> 24)) & 0x00000000ff00ff00ULL;
+    b ^= t ^ (t << 24);
+}
+
+/* 8x8 byte matrix transpose, w[i] byte j <-> w[j] byte i */
+static HARAKA_INLINE void transpose8x8_bytes(uint64_t *w)
+{
+    for (unsigned d = 1; d < 8; d <<= 1) {
+        const uint64_t m = d == 1 ? 0x00ff00ff00ff00ffULL
+                         : d == 2 ? 0x0000ffff0000ffffULL
+                         :          0x00000000ffffffffULL;
+        for (unsigned i = 0; i < 8; ++i)
+            if (!(i & d)) {
+                const uint64_t t = ((w[i] >> (8*d)) ^ w[i + d]) & m;
+                w[i + d] ^= t;
+                w[i] ^= t << (8*d);
+            }
+    }
+}
+
+/* 8x8 bit matrix transpose inside one word, byte i bit j <-> byte j bit i */
+static HARAKA_INLINE uint64_t transpose8x8_bits(uint64_t x)
+{
+    uint64_t t;
+    t = (x ^ (x >> 7))  & 0x00aa00aa00aa00aaULL; x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000cccc0000ccccULL; x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ULL; x ^= t ^ (t << 28);
+    return x;
+}
+
+/* r[s] = row-major word of state s  <->  r[k] = plane k (involution) */
+static HARAKA_INLINE void slice8(uint64_t *r)
+{
+    transpose8x8_bytes(r);               /* r[g] byte s = state s, group g */
+    for (unsigned g = 0; g < 8; ++g)
+        r[g] = transpose8x8_bits(r[g]);  /* r[g] byte k = plane k bits     */
+    transpose8x8_bytes(r);               /* r[k] byte g = plane k, group g */
+}
+
+/* in: 8 inputs of `len` bytes each */
+template <unsigned Blocks>
+static void bs_load(State<Blocks> &st, const uint8_t *in, unsigned len)
+{
+    for (unsigned b = 0; b < Blocks; ++b) {
+        uint64_t r[2][8];
+
+        for (unsigned s = 0; s < 8; ++s) {
+            uint64_t a = load64(in + s*len + 16*b);
+            uint64_t c = load64(in + s*len + 16*b + 8);
+            transpose4x4(a, c);
+            r[0][s] = a;
+            r[1][s] = c;
+        }
+        for (unsigned w = 0; w < 2; ++w) {
+            slice8(r[w]);
+            for (unsigned k = 0; k < 8; ++k)
+                st.p[k].v[w*Blocks + b] = r[w][k];
+        }
+    }
+}
+
+/* inverse of bs_load for block b: a[s] / c[s] = bytes 0..7 / 8..15 */
+template <unsigned Blocks>
+static HARAKA_INLINE void bs_unload(uint64_t *a, uint64_t *c,
+                                    const State<Blocks> &st, unsigned b)
+{
+    uint64_t r[2][8];
+
+    for (unsigned w = 0; w < 2; ++w) {
+        for (unsigned k = 0; k < 8; ++k)
+            r[w][k] = st.p[k].v[w*Blocks + b];
+        slice8(r[w]);
+    }
+    for (unsigned s = 0; s < 8; ++s) {
+        a[s] = r[0][s];
+        c[s] = r[1][s];
+        transpose4x4(a[s], c[s]);
+    }
+}
+
+/*──────────────── permutation ────────────────────────────────────*/
+template <class V>
+static void bs_permute(State<V::blocks> &st)
+{
+    for (unsigned r = 0; r < V::rounds; ++r) {
+        for (unsigned j = 0; j < V::aes; ++j)
+            bs_aes<V>(st, r*V::aes + j);
+        bs_mix<V::blocks>(st);
+    }
+}
+
+/* permutation + feed-forward + truncation (bytes 8..15 of each block) */
+template <class V>
+static void bs_trunc512(uint8_t *out, const uint8_t *in)
+{
+    State<4> st;
+
+    bs_load<4>(st, in, 64);
+    bs_permute<V>(st);
+    for (unsigned b = 0; b < 4; ++b) {
+        uint64_t a[8], c[8];
+
+        bs_unload<4>(a, c, st, b);
+        for (unsigned s = 0; s < 8; ++s)
+            store64(out + 32*s + 8*b, c[s] ^ load64(in + 64*s + 16*b + 8));
+    }
+}
+
+} /* namespace */
+
+/*──────────────── Public 8-way Entry Points ─────────────────────*/
+/* in = 8 consecutive 64-byte inputs, out = 8 consecutive 32-byte hashes */
+void haraka512_port_bs8(uint8_t *out, const uint8_t *in)
+{
+    bs_trunc512<haraka::Haraka512>(out, in);
+}
+
+void haraka512_port_zero_bs8(uint8_t *out, const uint8_t *in)
+{
+    bs_trunc512<haraka::Haraka512Zero>(out, in);
+}
+
+/* in = 8 consecutive 32-byte inputs, out = 8 consecutive 32-byte hashes */
+void haraka256_port_bs8(uint8_t *out, const uint8_t *in)
+{
+    State<2> st;
+
+    bs_load<2>(st, in, 32);
+    bs_permute<haraka::Haraka256>(st);
+    for (unsigned b = 0; b < 2; ++b) {
+        uint64_t a[8], c[8];
+
+        bs_unload<2>(a, c, st, b);
+        for (unsigned s = 0; s < 8; ++s) {
+            store64(out + 32*s + 16*b,     a[s] ^ load64(in + 32*s + 16*b));
+            store64(out + 32*s + 16*b + 8, c[s] ^ load64(in + 32*s + 16*b + 8));
+        }
+    }
+}
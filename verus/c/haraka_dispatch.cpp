@@ -0,0 +1,188 @@
+/*--------------------------------------------------------------------
+ * haraka_dispatch.cpp  –  cpuid selection of the Haraka engines
+ *
+ *   x86 hosts only (see build.sh).  Every engine pointer starts at a
+ *   trampoline that probes the CPU, installs the chosen engines and
+ *   forwards the call, so the first hash pays for the probe and every
+ *   later one is a relaxed load and a single indirect call.
+ *
+ *   The pointers and the probed state are atomics, so threads that
+ *   race through the trampolines, or hash while
+ *   ForceCPUHarakaOptimized() swaps the engines, are well defined.  A
+ *   thread may briefly run engines of two levels side by side, which
+ *   is harmless: they are bit-exact.
+ *
+ *   AES-NI is not an option: AESENC applies the real AES S-box, while
+ *   VerusHash on Solana is defined by the truncated VRSC S-box of
+ *   haraka_sbox.h.  The vector-permute engines reproduce that S-box
+ *   bit for bit and are the fastest single-state engines available:
+ *
+ *     level 2  AVX2   haraka*_vperm, batches through haraka*_vperm_x2
+ *     level 1  SSSE3  haraka*_vperm
+ *     level 0         haraka*_port (T-tables)
+ *
+ *   clmul_mix_fn is PCLMULQDQ at level >= 1 when the CPU has it, the
+ *   windowed clmul_mix() otherwise.  Full VerusHash 2.2 (verus_hash2b)
+ *   is upstream Haraka, so there AES-NI is the right engine; it asks
+ *   IsCPUVerusOptimized() under the same level.
+ *------------------------------------------------------------------*/
+#include "haraka_dispatch.h"
+#include "haraka_x86.h"
+
+#include <atomic>
+#include <cpuid.h>
+#include <stdlib.h>
+
+/* Level in bits 0..3 plus the CPU flags, in one word so a reader sees
+   a level and the flags of the same probe; 0x80: not probed yet */
+#define CPU_LEVEL  0x0f
+#define CPU_PCLMUL 0x10
+#define CPU_AES    0x20
+#define CPU_UNSET  0x80
+
+static std::atomic<int> __cpuharakaoptimized(CPU_UNSET);
+
+/* CPU_* flags | the highest level the CPU (and the environment) allow */
+static int probe_level()
+{
+    const char *env = getenv("VERUS_HASH_PORTABLE");
+    unsigned int eax, ebx, ecx, edx;
+    int level = 0;
+
+    if (env && *env && !(env[0] == '0' && env[1] == 0))
+        return 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return 0;
+    const int flags = (ecx & bit_PCLMUL ? CPU_PCLMUL : 0) | (ecx & bit_AES ? CPU_AES : 0);
+    if (ecx & bit_SSSE3)
+        level = 1;
+
+    /* AVX2 also needs the OS to save the ymm registers (XCR0 bits 1,2) */
+    if ((ecx & (bit_OSXSAVE | bit_AVX)) == (bit_OSXSAVE | bit_AVX) &&
+        __get_cpuid_max(0, 0) >= 7)
+    {
+        unsigned int xcr0, xcr0_hi;
+        __asm__ ("xgetbv" : "=a"(xcr0), "=d"(xcr0_hi) : "c"(0));
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        if ((ebx & bit_AVX2) && (xcr0 & 6) == 6)
+            level = 2;
+    }
+    return flags | level;
+}
+
+static int cpu_state()
+{
+    int state = __cpuharakaoptimized.load(std::memory_order_relaxed);
+
+    if (state & CPU_UNSET) {
+        state = probe_level();
+        __cpuharakaoptimized.store(state, std::memory_order_relaxed);
+    }
+    return state;
+}
+
+/*---------------- batch engines ------------------------------------*/
+/* four states through the one-state (SSSE3) or two-state (AVX2) engine */
+#define VPERM_X4(name, x2, in_len)                                  \
+    static void name##_x4(uint8_t *out, const uint8_t *in)          \
+    {                                                               \
+        for (int i = 0; i < 4; ++i)                                 \
+            name(out + 32 * i, in + (in_len) * i);                  \
+    }                                                               \
+    static void name##_x2x2(uint8_t *out, const uint8_t *in)        \
+    {                                                               \
+        x2(out, in);                                                \
+        x2(out + 64, in + 2 * (in_len));                            \
+    }
+
+VPERM_X4(haraka512_vperm,      haraka512_vperm_x2,      64)
+VPERM_X4(haraka512_vperm_zero, haraka512_vperm_zero_x2, 64)
+VPERM_X4(haraka256_vperm,      haraka256_vperm_x2,      32)
+
+static uint64_t clmul_mix_port(uint64_t a, uint64_t b)
+{
+    return clmul_mix(a, b);
+}
+
+/*---------------- selection ----------------------------------------*/
+static void install(int level);
+
+/* initial engine of name##_fn: select the engines, then forward */
+#define FIRST(name)                                                 \
+    static void name##_first(uint8_t *out, const uint8_t *in)       \
+    {                                                               \
+        install(cpu_state());                                       \
+        name##_fn(out, in);                                         \
+    }
+
+FIRST(haraka512)
+FIRST(haraka512_zero)
+FIRST(haraka256)
+FIRST(haraka512_x4)
+FIRST(haraka512_zero_x4)
+FIRST(haraka256_x4)
+
+static uint64_t clmul_mix_first(uint64_t a, uint64_t b)
+{
+    install(cpu_state());
+    return clmul_mix_fn(a, b);
+}
+
+std::atomic<haraka_fn_t> haraka512_engine(haraka512_first);
+std::atomic<haraka_fn_t> haraka512_zero_engine(haraka512_zero_first);
+std::atomic<haraka_fn_t> haraka256_engine(haraka256_first);
+std::atomic<haraka_fn_t> haraka512_x4_engine(haraka512_x4_first);
+std::atomic<haraka_fn_t> haraka512_zero_x4_engine(haraka512_zero_x4_first);
+std::atomic<haraka_fn_t> haraka256_x4_engine(haraka256_x4_first);
+std::atomic<clmul_fn_t>  clmul_mix_engine(clmul_mix_first);
+
+static void set(std::atomic<haraka_fn_t> &engine, haraka_fn_t fn)
+{
+    engine.store(fn, std::memory_order_relaxed);
+}
+
+/* state: a cpu_state() word */
+static void install(int state)
+{
+    const int level = state & CPU_LEVEL;
+
+    clmul_mix_engine.store(level >= 1 && (state & CPU_PCLMUL) ? clmul_mix_pclmul : clmul_mix_port,
+                           std::memory_order_relaxed);
+    if (level >= 1) {
+        set(haraka512_engine,         haraka512_vperm);
+        set(haraka512_zero_engine,    haraka512_vperm_zero);
+        set(haraka256_engine,         haraka256_vperm);
+        set(haraka512_x4_engine,      level >= 2 ? haraka512_vperm_x2x2 : haraka512_vperm_x4);
+        set(haraka512_zero_x4_engine, level >= 2 ? haraka512_vperm_zero_x2x2
+                                                 : haraka512_vperm_zero_x4);
+        set(haraka256_x4_engine,      level >= 2 ? haraka256_vperm_x2x2 : haraka256_vperm_x4);
+    } else {
+        set(haraka512_engine,         haraka512_port);
+        set(haraka512_zero_engine,    haraka512_port_zero);
+        set(haraka256_engine,         haraka256_port);
+        set(haraka512_x4_engine,      haraka512_port_x4);
+        set(haraka512_zero_x4_engine, haraka512_port_zero_x4);
+        set(haraka256_x4_engine,      haraka256_port_x4);
+    }
+}
+
+int IsCPUHarakaOptimized(void)
+{
+    return cpu_state() & CPU_LEVEL;
+}
+
+void ForceCPUHarakaOptimized(int level)
+{
+    const int cpu = probe_level();
+    const int state = level < 0 || level > (cpu & CPU_LEVEL) ? cpu : (cpu & ~CPU_LEVEL) | level;
+
+    __cpuharakaoptimized.store(state, std::memory_order_relaxed);
+    install(state);
+}
+
+int IsCPUVerusOptimized(void)
+{
+    const int state = cpu_state();
+
+    return (state & CPU_LEVEL) >= 1 && (state & CPU_AES) && (state & CPU_PCLMUL);
+}
@@ -0,0 +1,98 @@
+/*───────────────────────────────────────────────────────────*
+ *  haraka_dispatch.h  –  Haraka engine used by the VerusHash *
+ *                        drivers (verus_hash.cpp)           *
+ *                                                           *
+ *  On x86 hosts the haraka*_fn names call through atomic    *
+ *  pointers that pick the fastest bit-exact engine once, by *
+ *  cpuid, on first use (haraka_dispatch.cpp).  Elsewhere -  *
+ *  SBF/BPF above all - they are plain aliases of the        *
+ *  portable functions, so nothing changes there.            *
+ *                                                           *
+ *  clmul_mix_fn (CLHASH step of v2.2) follows the same      *
+ *  rule: PCLMULQDQ when the CPU has it, else clmul_mix().   *
+ *                                                           *
+ *  Setting VERUS_HASH_PORTABLE (to anything but "0") in the *
+ *  environment forces the portable engines.                 *
+ *───────────────────────────────────────────────────────────*/
+#ifndef HARAKA_DISPATCH_H
+#define HARAKA_DISPATCH_H
+
+#include "haraka_portable.h"
+#include "verus_clhash.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(__bpf__) && !defined(__BPF__)
+#  define HARAKA_DISPATCH 1
+#else
+#  define HARAKA_DISPATCH 0
+#endif
+
+#if HARAKA_DISPATCH
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*haraka_fn_t)(uint8_t *out, const uint8_t *in);
+typedef uint64_t (*clmul_fn_t)(uint64_t a, uint64_t b);
+
+/* Engine level in use: 0 portable, 1 SSSE3 vperm, 2 AVX2 vperm;
+   PCLMULQDQ is used at any level >= 1 where the CPU has it.
+   Probes the CPU (and VERUS_HASH_PORTABLE) on the first call. */
+int IsCPUHarakaOptimized(void);
+
+/* Pins the engines to `level` (clamped to what the CPU supports);
+   a negative level re-probes.  Safe while other threads hash. */
+void ForceCPUHarakaOptimized(int level);
+
+/* Nonzero when full VerusHash 2.2 (verus_hash2b.h) may use its AES-NI
+   engine: level >= 1 and the CPU has AES-NI and PCLMULQDQ. */
+int IsCPUVerusOptimized(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+
+#include <atomic>
+
+/* The engines in use, behind haraka*_fn() / clmul_mix_fn() with the
+   same contracts as haraka512_port, haraka512_port_zero, haraka256_port,
+   their _x4 batch forms and clmul_mix.  The pointers are atomics read
+   relaxed: the first call and ForceCPUHarakaOptimized() may swap them
+   while other threads hash, and as every engine gives the same bytes a
+   call only needs some whole pointer, not the latest one. */
+#define HARAKA_ENGINE(name)                                         \
+    extern std::atomic<haraka_fn_t> name##_engine;                  \
+    static inline void name##_fn(uint8_t *out, const uint8_t *in)   \
+    {                                                               \
+        name##_engine.load(std::memory_order_relaxed)(out, in);     \
+    }
+
+HARAKA_ENGINE(haraka512)
+HARAKA_ENGINE(haraka512_zero)
+HARAKA_ENGINE(haraka256)
+HARAKA_ENGINE(haraka512_x4)
+HARAKA_ENGINE(haraka512_zero_x4)
+HARAKA_ENGINE(haraka256_x4)
+
+#undef HARAKA_ENGINE
+
+extern std::atomic<clmul_fn_t> clmul_mix_engine;
+
+static inline uint64_t clmul_mix_fn(uint64_t a, uint64_t b)
+{
+    return clmul_mix_engine.load(std::memory_order_relaxed)(a, b);
+}
+#endif /* __cplusplus */
+
+#else /* !HARAKA_DISPATCH */
+
+#  define haraka512_fn          haraka512_port
+#  define haraka512_zero_fn     haraka512_port_zero
+#  define haraka256_fn          haraka256_port
+#  define haraka512_x4_fn       haraka512_port_x4
+#  define haraka512_zero_x4_fn  haraka512_port_zero_x4
+#  define haraka256_x4_fn       haraka256_port_x4
+#  define clmul_mix_fn          clmul_mix
+
+#endif /* HARAKA_DISPATCH */
+#endif /* HARAKA_DISPATCH_H */
@@ -0,0 +1,146 @@
+/*--------------------------------------------------------------------
+ * haraka_gather_avx2.cpp  –  AVX2 gather Haraka, 8 states at once
+ *
+ *   The portable T-table round with one 32-bit lane per state: lane i
+ *   of eight independent Haraka states lives in one ymm register, and
+ *   every T[k][byte] lookup is a single vpgatherdd for all eight.
+ *   Built with -mavx2 on x86 hosts only (see build.sh); the caller
+ *   must make sure the CPU has AVX2.  Results are byte-identical to
+ *   haraka512_port / haraka512_port_zero / haraka256_port.
+ *
+ *   Gather throughput differs by an order of magnitude between cores,
+ *   so bench_haraka.cpp times this against the other engines.
+ *------------------------------------------------------------------*/
+#include "haraka_x86.h"
+#include "haraka_tmpl.h"
+#include "haraka_sbox.h"
+
+#include <immintrin.h>
+
+namespace {
+
+/* same layout and values as the 4 KiB tables of haraka_portable.cpp */
+static const uint32_t T[4][256] = { SBOX(U0), SBOX(U1), SBOX(U2), SBOX(U3) };
+
+template <unsigned K>
+static HARAKA_INLINE __m256i te(__m256i idx)
+{
+    return _mm256_i32gather_epi32((const int *)T[K], idx, 4);
+}
+
+/* byte K of every lane, as a gather index */
+template <unsigned K>
+static HARAKA_INLINE __m256i byte_of(__m256i x)
+{
+    const __m256i ff = _mm256_set1_epi32(0xff);
+
+    if (K == 0)
+        return _mm256_and_si256(x, ff);
+    if (K == 3)
+        return _mm256_srli_epi32(x, 24);
+    return _mm256_and_si256(_mm256_srli_epi32(x, 8*K), ff);
+}
+
+/* AESENC on four column registers (8 states each), key excluded */
+struct GatherAes {
+    static HARAKA_INLINE void round(__m256i &c0, __m256i &c1,
+                                    __m256i &c2, __m256i &c3)
+    {
+        const __m256i x0 = c0, x1 = c1, x2 = c2, x3 = c3;
+
+        c0 = _mm256_xor_si256(_mm256_xor_si256(te<0>(byte_of<0>(x0)), te<1>(byte_of<1>(x1))),
+                              _mm256_xor_si256(te<2>(byte_of<2>(x2)), te<3>(byte_of<3>(x3))));
+        c1 = _mm256_xor_si256(_mm256_xor_si256(te<0>(byte_of<0>(x1)), te<1>(byte_of<1>(x2))),
+                              _mm256_xor_si256(te<2>(byte_of<2>(x3)), te<3>(byte_of<3>(x0))));
+        c2 = _mm256_xor_si256(_mm256_xor_si256(te<0>(byte_of<0>(x2)), te<1>(byte_of<1>(x3))),
+                              _mm256_xor_si256(te<2>(byte_of<2>(x0)), te<3>(byte_of<3>(x1))));
+        c3 = _mm256_xor_si256(_mm256_xor_si256(te<0>(byte_of<0>(x3)), te<1>(byte_of<1>(x0))),
+                              _mm256_xor_si256(te<2>(byte_of<2>(x1)), te<3>(byte_of<3>(x2))));
+    }
+};
+
+/* x[i] = lane i of states 0..7; MIX is applied physically, the loop
+   over rounds stays rolled to keep the gathers in the uop cache */
+template <class V>
+static HARAKA_INLINE void permute(__m256i *x)
+{
+    for (unsigned r = 0; r < V::rounds; ++r) {
+        for (unsigned j = 0; j < V::aes; ++j)
+            for (unsigned b = 0; b < V::blocks; ++b) {
+                __m256i *c = x + 4*b;
+
+                GatherAes::round(c[0], c[1], c[2], c[3]);
+                if (V::keyed) {
+                    const unsigned i = V::rc_index(r, j, b);
+                    for (unsigned k = 0; k < 4; ++k)
+                        c[k] = _mm256_xor_si256(
+                            c[k], _mm256_set1_epi32((int)haraka::rc_lane(i, k)));
+                }
+            }
+
+        __m256i t[V::lanes];
+        for (unsigned i = 0; i < V::lanes; ++i)
+            t[i] = x[haraka::mix_src(V::blocks, i)];
+        for (unsigned i = 0; i < V::lanes; ++i)
+            x[i] = t[i];
+    }
+}
+
+/* lane i of 8 inputs `len` bytes apart */
+static HARAKA_INLINE __m256i load_lane(const uint8_t *in, unsigned len, unsigned i)
+{
+    const int s = (int)(len / 4);
+    const __m256i idx = _mm256_setr_epi32(0, s, 2*s, 3*s, 4*s, 5*s, 6*s, 7*s);
+
+    return _mm256_i32gather_epi32((const int *)(in + 4*i), idx, 4);
+}
+
+static HARAKA_INLINE void store_lane(uint8_t *out, __m256i v, unsigned i)
+{
+    alignas(32) uint32_t w[8];
+
+    _mm256_store_si256((__m256i *)w, v);
+    for (unsigned s = 0; s < 8; ++s) {
+        uint8_t *p = out + 32*s + 4*i;
+        p[0] = (uint8_t)w[s];         p[1] = (uint8_t)(w[s] >> 8);
+        p[2] = (uint8_t)(w[s] >> 16); p[3] = (uint8_t)(w[s] >> 24);
+    }
+}
+
+/* permutation + feed-forward + truncation (lanes 2,3 of each block) */
+template <class V>
+static void perm_trunc_x8(uint8_t *out, const uint8_t *in)
+{
+    __m256i x[16];
+
+    for (unsigned i = 0; i < 16; ++i)
+        x[i] = load_lane(in, 64, i);
+    permute<V>(x);
+    for (unsigned b = 0; b < 4; ++b)
+        for (unsigned k = 2; k < 4; ++k)
+            store_lane(out, _mm256_xor_si256(x[4*b + k], load_lane(in, 64, 4*b + k)),
+                       2*b + k - 2);
+}
+
+} /* namespace */
+
+void haraka512_gather_x8(uint8_t *out, const uint8_t *in)
+{
+    perm_trunc_x8<haraka::Haraka512>(out, in);
+}
+
+void haraka512_gather_zero_x8(uint8_t *out, const uint8_t *in)
+{
+    perm_trunc_x8<haraka::Haraka512Zero>(out, in);
+}
+
+void haraka256_gather_x8(uint8_t *out, const uint8_t *in)
+{
+    __m256i x[8];
+
+    for (unsigned i = 0; i < 8; ++i)
+        x[i] = load_lane(in, 32, i);
+    permute<haraka::Haraka256>(x);
+    for (unsigned i = 0; i < 8; ++i)
+        store_lane(out, _mm256_xor_si256(x[i], load_lane(in, 32, i)), i);
+}
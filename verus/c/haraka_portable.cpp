@@ -0,0 +1,397 @@
+/*--------------------------------------------------------------------
+ * haraka_portable.cpp  –  portable (non-AES-NI) Haraka for VerusHash
+ *                         works on both x86-64 and Solana SBF/BPF.
+ *   – no libc, no dynamic allocation, stack-safe (≤512 B)
+ *   – rounds are unrolled at compile time, see haraka_tmpl.h
+ *------------------------------------------------------------------*/
+#include "haraka_portable.h"
+#include "haraka_tmpl.h"
+#include "haraka_sbox.h"
+#include "common.h"               /* upstream typedefs (u128, …)      */
+
+/*------------------------------------------------------------------*
+ *  Solana-BPF loader: section names must not exceed 16 bytes.       *
+ *  Tell Clang to put every static variable after this point         *
+ *  straight into plain sections instead of ".<sec>.<mangled-name>". *
+ *------------------------------------------------------------------*/
+#if defined(__clang__) && defined(__ELF__)
+// #pragma clang section bss    = ".bss"    /* Removed: No static writable data allowed */
+#  pragma clang section data   = ".data"   /* Initialised globals */
+#  pragma clang section rodata = ".rodata" /* Read-only globals (const) */
+#endif /* __clang__ && __ELF__ */
+
+/*──────────────── tiny memcpy / memset (exported) ────────────────*/
+void *verus_memcpy(void *d, const void *s, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        ((uint8_t *)d)[i] = ((const uint8_t *)s)[i];
+    return d;
+}
+void *verus_memset(void *p, int c, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        ((uint8_t *)p)[i] = (uint8_t)c;
+    return p;
+}
+
+/* alias them locally */
+#define memcpy  verus_memcpy
+#define memset  verus_memset
+
+/* Forward declaration for internal sponge function */
+static void haraka_S(uint8_t *out, uint64_t outlen, const uint8_t *in, uint64_t inlen);
+
+/*──────────────── compile-time AES T-tables (exact upstream math) ─*/
+/* WPOLY/F2/F3/B2W/U0..U3 and SBOX() come from haraka_sbox.h */
+
+/* HARAKA_PACKED64 selects the 64-bit packed-pair round kernel (two
+   columns per register, 64-bit table entries).  It is the default on
+   SBF, whose VM has 64-bit registers only and charges per instruction;
+   hosts keep the 32-bit lane kernel unless built with -DHARAKA_PACKED64=1.
+
+   HARAKA_AES_TABLES selects the table layout of the 32-bit lane kernel:
+     4  T[4][256]      4 KiB   one lookup per byte (default)
+     1  T0[256]        1 KiB   T[k][x] = rotl32(T0[x], 8k)
+     0  S[256]         256 B   S-box only, MixColumns by xtime
+   The packed kernel has its own 16 KiB layout, so a smaller table
+   implies the lane kernel on SBF too (build.sh: VERUS_AES_TABLES). */
+#ifndef HARAKA_AES_TABLES
+#  define HARAKA_AES_TABLES 4
+#endif
+#ifndef HARAKA_PACKED64
+#  if (defined(__bpf__) || defined(__BPF__)) && HARAKA_AES_TABLES == 4
+#    define HARAKA_PACKED64 1
+#  else
+#    define HARAKA_PACKED64 0
+#  endif
+#endif
+#if HARAKA_PACKED64 && HARAKA_AES_TABLES != 4
+#  error "HARAKA_PACKED64 uses its own table layout; leave HARAKA_AES_TABLES at 4"
+#endif
+#if HARAKA_AES_TABLES != 4 && HARAKA_AES_TABLES != 1 && HARAKA_AES_TABLES != 0
+#  error "HARAKA_AES_TABLES must be 4, 1 or 0"
+#endif
+
+/* HARAKA_X4_INTERLEAVE = states whose rounds the _x4 entry points
+   interleave per pass (1, 2 or 4).  One Haraka-512 state already gives
+   four independent AES blocks per step, which keeps the load ports of
+   current x86-64 cores busy; a second state only adds register spills
+   and doubles the unrolled body, so 2/4 measured slower there and are
+   opt-in for targets with larger register files. */
+#ifndef HARAKA_X4_INTERLEAVE
+#  define HARAKA_X4_INTERLEAVE 1
+#endif
+#if HARAKA_X4_INTERLEAVE != 1 && HARAKA_X4_INTERLEAVE != 2 && HARAKA_X4_INTERLEAVE != 4
+#  error "HARAKA_X4_INTERLEAVE must be 1, 2 or 4"
+#endif
+
+#if HARAKA_PACKED64
+/* T64[h][k] = T[k] shifted into half h of the 64-bit output word */
+#define L0(p)   ((uint64_t)U0(p))
+#define L1(p)   ((uint64_t)U1(p))
+#define L2(p)   ((uint64_t)U2(p))
+#define L3(p)   ((uint64_t)U3(p))
+#define H0(p)   ((uint64_t)U0(p) << 32)
+#define H1(p)   ((uint64_t)U1(p) << 32)
+#define H2(p)   ((uint64_t)U2(p) << 32)
+#define H3(p)   ((uint64_t)U3(p) << 32)
+
+static const uint64_t T64[2][4][256] = {
+    { SBOX(L0), SBOX(L1), SBOX(L2), SBOX(L3) },
+    { SBOX(H0), SBOX(H1), SBOX(H2), SBOX(H3) }
+};
+#elif HARAKA_AES_TABLES == 4
+static const uint32_t T[4][256] = { SBOX(U0), SBOX(U1), SBOX(U2), SBOX(U3) };
+#elif HARAKA_AES_TABLES == 1
+static const uint32_t T0[256] = SBOX(U0);
+#else
+#define SB(p)   ((uint8_t)(p))
+static const uint8_t S[256] = SBOX(SB);
+#endif
+
+/*──────────────── 32-bit lane load/store (little-endian) ─────────*/
+/* Assembled from bytes so neither the host nor the SBF build has to go
+   through verus_memcpy; compilers fold these into single loads/stores
+   where the target allows unaligned access. */
+static inline uint32_t lane_load(const uint8_t *p)
+{
+    return (uint32_t)p[0]         | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+static inline void lane_store(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;         p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+/*──────────────── round constants ───────────────────────────────*/
+// Define the constant array using the included initializer.
+// The build system (build.rs) generates `haraka_rc_vrsc.inc` and copies it
+// to `verus/c/` so the `#include` below finds it.
+// We declare it `extern const` first and then define it without `static`
+// to ensure it has external linkage and isn't optimized away by the C++
+// compiler during host builds when only C functions reference it.
+// Define the constant array using the included initializer.
+// The build system (build.rs) generates `haraka_rc_vrsc.inc` and copies it
+// to `verus/c/` so the `#include` below finds it.
+// We declare it `extern const` first and then define it without `static`
+// to ensure it has external linkage and isn't optimized away by the C++
+// compiler during host builds when only C functions reference it.
+// haraka_tmpl.h includes the same initializer as a constexpr copy
+// (haraka::kRC) so the unrolled permutations see immediates; this one
+// is the exported table the Rust side reads.
+extern "C" const uint8_t rc[40][16]; // Declaration with external linkage
+extern "C" const uint8_t rc[40][16] = // Definition
+#include "haraka_rc_vrsc.inc"
+;
+
+// NOTE: The static writable rc buffer, rc_init, rc_host, rc_bpf functions
+// that were previously here have been removed.
+// The const `rc` array defined above is now used directly by the permutations below.
+
+/*──────────────── Internal Sponge Utilities (Haraka-S) ──────────*/
+// Sponge logic is no longer needed here as constants are pre-generated.
+
+#if HARAKA_PACKED64
+/*──────────────── 64-bit packed-pair kernel (SBF) ───────────────*/
+static inline uint64_t word_load(const uint8_t *p)
+{
+    return (uint64_t)lane_load(p) | ((uint64_t)lane_load(p + 4) << 32);
+}
+static inline void word_store(uint8_t *p, uint64_t v)
+{
+    lane_store(p, (uint32_t)v);
+    lane_store(p + 4, (uint32_t)(v >> 32));
+}
+
+struct Table64 {
+    template <unsigned H, unsigned M>
+    static HARAKA_INLINE uint64_t get(uintptr_t off)
+    {
+        return *(const uint64_t *)((const uint8_t *)T64[H][M] + off);
+    }
+};
+
+/* permutation + feed-forward + truncation to 256 bits, for N states:
+   input n at in + n*64, output n at out + n*32 */
+template <class V, unsigned N = 1>
+static HARAKA_INLINE void perm_trunc(uint8_t *out, const uint8_t *in)
+{
+    typedef haraka::Packed<V> P;
+    uint64_t y[N * P::regs];
+
+    for (unsigned w = 0; w < N * P::regs; ++w)
+        y[w] = word_load(in + 8*w);
+    haraka::permute_packed<V, Table64, N>(y);
+
+    /* bytes 8, 24, 40, 56: word 2b+1 of the state */
+    static_assert(P::out_packed(1) && P::out_packed(3) &&
+                  P::out_packed(5) && P::out_packed(7), "layout");
+    for (unsigned n = 0; n < N; ++n) {
+        const uint64_t *z = y + n * P::regs;
+        const uint8_t *x = in + 64*n;
+        uint8_t *o = out + 32*n;
+
+        word_store(o +  0, z[P::out_reg(1)] ^ word_load(x +  8));
+        word_store(o +  8, z[P::out_reg(3)] ^ word_load(x + 24));
+        word_store(o + 16, z[P::out_reg(5)] ^ word_load(x + 40));
+        word_store(o + 24, z[P::out_reg(7)] ^ word_load(x + 56));
+    }
+}
+
+/* full-width permutation, optional feed-forward, for N states stored
+   back to back in both in and out */
+template <class V, bool FeedForward, unsigned N = 1>
+static HARAKA_INLINE void perm_full(uint8_t *out, const uint8_t *in)
+{
+    typedef haraka::Packed<V> P;
+    uint64_t y[N * P::regs];
+
+    for (unsigned w = 0; w < N * P::regs; ++w)
+        y[w] = word_load(in + 8*w);
+    haraka::permute_packed<V, Table64, N>(y);
+
+    static_assert(P::all_out_packed(), "layout");
+    for (unsigned n = 0; n < N; ++n)
+        for (unsigned w = 0; w < P::regs; ++w) {
+            const uint64_t v = y[n * P::regs + P::out_reg(w)];
+            const unsigned i = n * P::regs + w;
+
+            word_store(out + 8*i, FeedForward ? v ^ word_load(in + 8*i) : v);
+        }
+}
+
+#else /* !HARAKA_PACKED64 */
+/*──────────────── software AESENC on four column lanes ──────────*/
+/* SubBytes + ShiftRows + MixColumns; the round key is xored by the
+   caller (haraka::Step) so the zero-key permutation skips it. */
+#if HARAKA_AES_TABLES != 0
+/* T-table entry for row K; the 1 KiB layout rotates T0 */
+template <unsigned K>
+static HARAKA_INLINE uint32_t te(uint32_t x)
+{
+#if HARAKA_AES_TABLES == 4
+    return T[K][x];
+#else
+    return K ? rotl32(T0[x], 8*K) : T0[x];
+#endif
+}
+
+struct TableAes {
+    static HARAKA_INLINE void round(uint32_t &c0, uint32_t &c1,
+                                    uint32_t &c2, uint32_t &c3)
+    {
+        const uint32_t x0 = c0, x1 = c1, x2 = c2, x3 = c3;
+
+        c0 = te<0>(x0 & 0xff) ^ te<1>((x1 >> 8) & 0xff) ^
+             te<2>((x2 >> 16) & 0xff) ^ te<3>(x3 >> 24);
+        c1 = te<0>(x1 & 0xff) ^ te<1>((x2 >> 8) & 0xff) ^
+             te<2>((x3 >> 16) & 0xff) ^ te<3>(x0 >> 24);
+        c2 = te<0>(x2 & 0xff) ^ te<1>((x3 >> 8) & 0xff) ^
+             te<2>((x0 >> 16) & 0xff) ^ te<3>(x1 >> 24);
+        c3 = te<0>(x3 & 0xff) ^ te<1>((x0 >> 8) & 0xff) ^
+             te<2>((x1 >> 16) & 0xff) ^ te<3>(x2 >> 24);
+    }
+};
+#else
+/* S-box only: SubBytes+ShiftRows gathers one column word, MixColumns
+   is computed on all four bytes at once:
+     out = xtime(c ^ rotr8(c)) ^ rotr8(c) ^ rotr16(c ^ rotr8(c))      */
+static HARAKA_INLINE uint32_t sb_col(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+{
+    return (uint32_t)S[a & 0xff]                |
+           ((uint32_t)S[(b >> 8) & 0xff] << 8)  |
+           ((uint32_t)S[(c >> 16) & 0xff] << 16) |
+           ((uint32_t)S[d >> 24] << 24);
+}
+
+static HARAKA_INLINE uint32_t mix_col(uint32_t c)
+{
+    const uint32_t r = rotr32(c, 8);
+    const uint32_t t = c ^ r;
+    const uint32_t x = ((t & 0x7f7f7f7f) << 1) ^ (((t >> 7) & 0x01010101) * 0x1b);
+
+    return x ^ r ^ rotr32(t, 16);
+}
+
+struct TableAes {
+    static HARAKA_INLINE void round(uint32_t &c0, uint32_t &c1,
+                                    uint32_t &c2, uint32_t &c3)
+    {
+        const uint32_t x0 = c0, x1 = c1, x2 = c2, x3 = c3;
+
+        c0 = mix_col(sb_col(x0, x1, x2, x3));
+        c1 = mix_col(sb_col(x1, x2, x3, x0));
+        c2 = mix_col(sb_col(x2, x3, x0, x1));
+        c3 = mix_col(sb_col(x3, x0, x1, x2));
+    }
+};
+#endif /* HARAKA_AES_TABLES */
+
+template <class V, unsigned N = 1>
+static HARAKA_INLINE void load_lanes(uint32_t *x, const uint8_t *in)
+{
+    for (unsigned i = 0; i < N * V::lanes; ++i)
+        x[i] = lane_load(in + 4*i);
+}
+
+/* permutation + feed-forward + truncation: lanes 2,3 of every 128-bit
+   block, i.e. bytes 8, 24, 40, 56 (spec-compliant Haraka-512 -> 256 bits).
+   N states: input n at in + n*64, output n at out + n*32 */
+template <class V, unsigned N = 1>
+static HARAKA_INLINE void perm_trunc(uint8_t *out, const uint8_t *in)
+{
+    uint32_t x[N * V::lanes];
+
+    load_lanes<V, N>(x, in);
+    haraka::permute<V, TableAes, N>(x);
+    for (unsigned n = 0; n < N; ++n) {
+        const uint32_t *y = x + n * V::lanes;
+
+        for (unsigned b = 0; b < 4; ++b) {
+            lane_store(out + 32*n + 8*b,
+                       y[haraka::out_slot<V>(4*b + 2)] ^ lane_load(in + 64*n + 16*b + 8));
+            lane_store(out + 32*n + 8*b + 4,
+                       y[haraka::out_slot<V>(4*b + 3)] ^ lane_load(in + 64*n + 16*b + 12));
+        }
+    }
+}
+
+/* full-width permutation, optional feed-forward, for N states stored
+   back to back in both in and out */
+template <class V, bool FeedForward, unsigned N = 1>
+static HARAKA_INLINE void perm_full(uint8_t *out, const uint8_t *in)
+{
+    uint32_t x[N * V::lanes];
+
+    load_lanes<V, N>(x, in);
+    haraka::permute<V, TableAes, N>(x);
+    for (unsigned n = 0; n < N; ++n)
+        for (unsigned i = 0; i < V::lanes; ++i) {
+            const uint32_t v = x[n * V::lanes + haraka::out_slot<V>(i)];
+            const unsigned k = n * V::lanes + i;
+
+            lane_store(out + 4*k, FeedForward ? v ^ lane_load(in + 4*k) : v);
+        }
+}
+#endif /* HARAKA_PACKED64 */
+
+/*──────────────── Public Haraka-512 Entry Point ─────────────────*/
+/* feed-forward + truncation (VerusHash needs this) */
+void haraka512_port(uint8_t *out, const uint8_t *in)
+{
+    perm_trunc<haraka::Haraka512>(out, in);
+}
+
+/*──────────────── Public Haraka-256 Entry Point ─────────────────*/
+/* feed-forward over the full 256 bits */
+void haraka256_port(uint8_t *out, const uint8_t *in)
+{
+    perm_full<haraka::Haraka256, true>(out, in);
+}
+
+/*──────────────── Internal Haraka-512 permutation (Zero Key) ───*/
+// Identical to haraka512_port's permutation but with zero round keys.
+void haraka512_perm_zero(unsigned char *out, const unsigned char *in)
+{
+    perm_full<haraka::Haraka512Zero, false>(out, in);
+}
+
+/*──────────────── Public Haraka-512 Entry Point (Zero Key) ─────*/
+/* feed-forward + truncation */
+void haraka512_port_zero(unsigned char *out, const unsigned char *in)
+{
+    perm_trunc<haraka::Haraka512Zero>(out, in);
+}
+
+/*──────────────── Public 4-way Entry Points ────────────────────*/
+/* Four independent hashes, the portable counterpart of haraka512_4x /
+   haraka256_4x: in = 4 consecutive inputs (64 bytes each for
+   Haraka-512, 32 for Haraka-256), out = 4 consecutive 32-byte results.
+   HARAKA_X4_INTERLEAVE states run through each pass together. */
+void haraka512_port_x4(uint8_t *out, const uint8_t *in)
+{
+    constexpr unsigned W = HARAKA_X4_INTERLEAVE;
+    for (unsigned n = 0; n < 4; n += W)
+        perm_trunc<haraka::Haraka512, W>(out + 32*n, in + 64*n);
+}
+
+void haraka512_port_zero_x4(uint8_t *out, const uint8_t *in)
+{
+    constexpr unsigned W = HARAKA_X4_INTERLEAVE;
+    for (unsigned n = 0; n < 4; n += W)
+        perm_trunc<haraka::Haraka512Zero, W>(out + 32*n, in + 64*n);
+}
+
+void haraka256_port_x4(uint8_t *out, const uint8_t *in)
+{
+    constexpr unsigned W = HARAKA_X4_INTERLEAVE;
+    for (unsigned n = 0; n < 4; n += W)
+        perm_full<haraka::Haraka256, true, W>(out + 32*n, in + 32*n);
+}
+
+/*──────────────── Helper for build-time generation ────────────*/
+// Removed get_vrsc_constants function as it's no longer needed.
+// Generation happens via generate_constants.c run by build.rs.
+
+/*───────────────────────────────────────────────────────────────*/
@@ -41,6 +41,21 @@ void haraka512_perm_zero(unsigned char *out, const unsigned char *in);
 /* Implementation of Haraka-512, using zero key */
 void haraka512_port_zero(unsigned char *out, const unsigned char *in);
 
+/* 4-way variants with interleaved rounds: in = 4 consecutive inputs
+   (64 bytes each for Haraka-512, 32 for Haraka-256), out = 4
+   consecutive 32-byte results, identical to four scalar calls. */
+void haraka512_port_x4(uint8_t *out, const uint8_t *in);
+void haraka512_port_zero_x4(uint8_t *out, const uint8_t *in);
+void haraka256_port_x4(uint8_t *out, const uint8_t *in);
+
+/* Bitsliced 8-way variants (haraka_bitslice.cpp): no table lookups,
+   constant time.  in = 8 consecutive inputs (64 bytes each for
+   Haraka-512, 32 for Haraka-256), out = 8 consecutive 32-byte results,
+   identical to eight calls of the scalar function. */
+void haraka512_port_bs8(uint8_t *out, const uint8_t *in);
+void haraka512_port_zero_bs8(uint8_t *out, const uint8_t *in);
+void haraka256_port_bs8(uint8_t *out, const uint8_t *in);
+
 /* get_vrsc_constants is removed; generation now happens in build.rs */
 
 #ifdef __cplusplus
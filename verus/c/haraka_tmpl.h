@@ -0,0 +1,293 @@
+/*───────────────────────────────────────────────────────────*
+ *  haraka_tmpl.h  –  compile-time specialised Haraka rounds *
+ *                    (C++ only, desktop & Solana SBF/BPF)   *
+ *                                                           *
+ *  Round count, round-constant offsets and the MIX lane     *
+ *  order are template parameters, so every permutation is   *
+ *  fully unrolled, round keys become immediates and MIX4 /  *
+ *  MIX2 are pure register renaming (no data movement).      *
+ *───────────────────────────────────────────────────────────*/
+#ifndef HARAKA_TMPL_H
+#define HARAKA_TMPL_H
+
+#ifndef __cplusplus
+#error "haraka_tmpl.h requires C++"
+#endif
+
+#include <stdint.h>
+
+/* the unrolled bodies are large; make sure neither host clang/gcc nor
+   the SBF back-end falls back to an out-of-line call per AES round   */
+#define HARAKA_INLINE inline __attribute__((always_inline))
+
+namespace haraka {
+
+/*──────────────── round constants (compile-time copy) ────────────*/
+/* Same initializer as the exported `rc` table in haraka_portable.cpp;
+   kept constexpr so the optimiser can fold the round keys. */
+static constexpr uint8_t kRC[40][16] =
+#include "haraka_rc_vrsc.inc"
+;
+
+/* little-endian 32-bit word k of round constant i */
+constexpr uint32_t rc_lane(unsigned i, unsigned k)
+{
+    return (uint32_t)kRC[i][4*k]             |
+           ((uint32_t)kRC[i][4*k + 1] << 8)  |
+           ((uint32_t)kRC[i][4*k + 2] << 16) |
+           ((uint32_t)kRC[i][4*k + 3] << 24);
+}
+
+/*──────────────── variants ───────────────────────────────────────*/
+/* Blocks = number of 128-bit blocks (4: Haraka-512, 2: Haraka-256) */
+template <unsigned Blocks, bool Keyed>
+struct Variant {
+    static constexpr unsigned blocks = Blocks;
+    static constexpr unsigned lanes  = 4 * Blocks;
+    static constexpr bool     keyed  = Keyed;
+    static constexpr unsigned rounds = 5;
+    static constexpr unsigned aes    = 2;              /* AES rounds per round */
+    static constexpr unsigned steps  = rounds * aes * Blocks;
+
+    /* round-constant index, i.e. rc[4*r*2 + 4*j + b] for Haraka-512 */
+    static constexpr unsigned rc_index(unsigned r, unsigned j, unsigned b)
+    {
+        return aes * Blocks * r + Blocks * j + b;
+    }
+};
+
+typedef Variant<4, true>  Haraka512;
+typedef Variant<4, false> Haraka512Zero;
+typedef Variant<2, true>  Haraka256;
+
+/*──────────────── MIX as lane renaming ───────────────────────────*/
+/* new lane i = old lane kMixN[i]; matches the unpacklo/unpackhi32
+   sequence of the reference MIX4 / MIX2 macros. */
+static constexpr unsigned kMix4[16] = { 3, 11,  7, 15,   8, 0, 12, 4,
+                                        9,  1, 13,  5,   2, 10, 6, 14 };
+static constexpr unsigned kMix2[8]  = { 0, 4, 1, 5,   2, 6, 3, 7 };
+
+constexpr unsigned mix_src(unsigned blocks, unsigned i)
+{
+    return blocks == 4 ? kMix4[i] : kMix2[i];
+}
+
+/* Physical register holding logical lane i at the start of round r.
+   Nothing is moved by MIX; later rounds simply address other slots. */
+template <class V>
+constexpr unsigned slot(unsigned r, unsigned i)
+{
+    return r == 0 ? i : slot<V>(r - 1, mix_src(V::blocks, i));
+}
+
+/* slot of logical lane i after the final MIX */
+template <class V>
+constexpr unsigned out_slot(unsigned i)
+{
+    return slot<V>(V::rounds, i);
+}
+
+/*──────────────── unrolled permutation ───────────────────────────*/
+/* One AES round on block B of AES step J in round R, for each of N
+   independent states stored back to back (V::lanes words apart); the
+   N rounds share no data, so their table loads overlap.  `Aes`
+   supplies SubBytes+ShiftRows+MixColumns on four column lanes:
+       static void round(uint32_t &c0, uint32_t &c1,
+                         uint32_t &c2, uint32_t &c3);              */
+template <class V, class Aes, unsigned K, unsigned N>
+struct Step {
+    static constexpr unsigned R = K / (V::aes * V::blocks);
+    static constexpr unsigned J = (K / V::blocks) % V::aes;
+    static constexpr unsigned B = K % V::blocks;
+
+    static HARAKA_INLINE void run(uint32_t *x)
+    {
+        constexpr unsigned s0 = slot<V>(R, 4*B + 0);
+        constexpr unsigned s1 = slot<V>(R, 4*B + 1);
+        constexpr unsigned s2 = slot<V>(R, 4*B + 2);
+        constexpr unsigned s3 = slot<V>(R, 4*B + 3);
+
+        for (unsigned n = 0; n < N; ++n) {
+            uint32_t *y = x + n * V::lanes;
+
+            Aes::round(y[s0], y[s1], y[s2], y[s3]);
+            if (V::keyed) {
+                constexpr unsigned i = V::rc_index(R, J, B);
+                y[s0] ^= rc_lane(i, 0);
+                y[s1] ^= rc_lane(i, 1);
+                y[s2] ^= rc_lane(i, 2);
+                y[s3] ^= rc_lane(i, 3);
+            }
+        }
+    }
+};
+
+template <class V, class Aes, unsigned K, unsigned N, bool Done = (K == V::steps)>
+struct Steps {
+    static HARAKA_INLINE void run(uint32_t *x)
+    {
+        Step<V, Aes, K, N>::run(x);
+        Steps<V, Aes, K + 1, N>::run(x);
+    }
+};
+
+template <class V, class Aes, unsigned K, unsigned N>
+struct Steps<V, Aes, K, N, true> {
+    static HARAKA_INLINE void run(uint32_t *) {}
+};
+
+/* Permutes N states of V::lanes lanes in place, state n at
+   x[n * V::lanes].  On return logical lane i of state n is in
+   x[n * V::lanes + out_slot<V>(i)]. */
+template <class V, class Aes, unsigned N = 1>
+static HARAKA_INLINE void permute(uint32_t *x)
+{
+    Steps<V, Aes, 0, N>::run(x);
+}
+
+/*──────────────── 64-bit packed pairs (SBF kernel) ───────────────*/
+/* Two 32-bit lanes per uint64_t.  Blocks are processed in pairs,
+   (0,2)(1,3) for Haraka-512 and (0,1) for Haraka-256: column k of both
+   blocks of pair p is register 4*p + k.  The half each block takes is
+   chosen so that after MIX the lanes (2q, 2q+1) of every new block are
+   (lo, hi) of one register, which keeps the natural 64-bit input words
+   and the truncated feed-forward output words free of repacking.
+
+   `Tab` supplies 64-bit T-table entries already shifted into the
+   requested output half H, addressed by a premultiplied byte offset:
+       template <unsigned H, unsigned M> static uint64_t get(uintptr_t off);
+   so one lookup costs shift + and + load, without index scaling. */
+
+constexpr unsigned inv_mix(unsigned blocks, unsigned s, unsigned i = 0)
+{
+    return mix_src(blocks, i) == s ? i : inv_mix(blocks, s, i + 1);
+}
+
+template <class V>
+struct Packed {
+    static constexpr unsigned regs  = V::lanes / 2;
+    static constexpr unsigned pairs = V::blocks / 2;
+    static constexpr unsigned steps = V::rounds * V::aes;
+
+    /* n-th block (0/1) of pair p */
+    static constexpr unsigned block(unsigned p, unsigned n) { return p + n * pairs; }
+
+    /* register / half receiving lane s of an AES step's output */
+    static constexpr unsigned fresh_reg(unsigned s)  { return 4 * ((s / 4) % pairs) + s % 4; }
+    static constexpr unsigned fresh_half(unsigned s) { return inv_mix(V::blocks, s) % 2; }
+
+    /* location of logical lane i at the input of AES step (r, j);
+       (V::rounds, 0) is the state after the final MIX */
+    static constexpr unsigned reg(unsigned r, unsigned j, unsigned i)
+    {
+        return (r == 0 && j == 0) ? i / 2
+             : j == 0             ? fresh_reg(mix_src(V::blocks, i))
+             :                      fresh_reg(i);
+    }
+    static constexpr unsigned half(unsigned r, unsigned j, unsigned i)
+    {
+        return (r == 0 && j == 0) ? i % 2
+             : j == 0             ? fresh_half(mix_src(V::blocks, i))
+             :                      fresh_half(i);
+    }
+
+    /* word w (lanes 2w, 2w+1) of the final state */
+    static constexpr unsigned out_reg(unsigned w) { return reg(V::rounds, 0, 2*w); }
+    static constexpr bool out_packed(unsigned w)
+    {
+        return reg(V::rounds, 0, 2*w) == reg(V::rounds, 0, 2*w + 1) &&
+               half(V::rounds, 0, 2*w) == 0 && half(V::rounds, 0, 2*w + 1) == 1;
+    }
+    static constexpr bool all_out_packed(unsigned w = 0)
+    {
+        return w == regs || (out_packed(w) && all_out_packed(w + 1));
+    }
+};
+
+/* byte at bit offset Sh of v, premultiplied by 8 */
+template <unsigned Sh>
+static HARAKA_INLINE uintptr_t packed_off(uint64_t v)
+{
+    if constexpr (Sh >= 3)
+        return (uintptr_t)((v >> (Sh - 3)) & 0x7f8);
+    else
+        return (uintptr_t)((v << (3 - Sh)) & 0x7f8);
+}
+
+/* T-table term of row M for output column K of block B */
+template <class V, class Tab, unsigned R, unsigned J, unsigned B, unsigned K, unsigned M>
+static HARAKA_INLINE uint64_t packed_term(const uint64_t *y)
+{
+    typedef Packed<V> P;
+    constexpr unsigned lane = 4*B + (K + M) % 4;
+    constexpr unsigned sh   = 32 * P::half(R, J, lane) + 8*M;
+
+    return Tab::template get<P::fresh_half(4*B + K), M>(
+        packed_off<sh>(y[P::reg(R, J, lane)]));
+}
+
+template <class V, class Tab, unsigned R, unsigned J, unsigned B, unsigned K>
+static HARAKA_INLINE uint64_t packed_col(const uint64_t *y)
+{
+    constexpr uint64_t key = V::keyed
+        ? (uint64_t)rc_lane(V::rc_index(R, J, B), K) << (32 * Packed<V>::fresh_half(4*B + K))
+        : 0;
+
+    return packed_term<V, Tab, R, J, B, K, 0>(y) ^ packed_term<V, Tab, R, J, B, K, 1>(y) ^
+           packed_term<V, Tab, R, J, B, K, 2>(y) ^ packed_term<V, Tab, R, J, B, K, 3>(y) ^ key;
+}
+
+/* output register I = 4*p + k of AES step (R, J) */
+template <class V, class Tab, unsigned R, unsigned J, unsigned I,
+          bool Done = (I == Packed<V>::regs)>
+struct PackedCols {
+    static HARAKA_INLINE void run(uint64_t *n, const uint64_t *y)
+    {
+        typedef Packed<V> P;
+        constexpr unsigned p = I / 4, k = I % 4;
+
+        n[I] = packed_col<V, Tab, R, J, P::block(p, 0), k>(y) ^
+               packed_col<V, Tab, R, J, P::block(p, 1), k>(y);
+        PackedCols<V, Tab, R, J, I + 1>::run(n, y);
+    }
+};
+
+template <class V, class Tab, unsigned R, unsigned J, unsigned I>
+struct PackedCols<V, Tab, R, J, I, true> {
+    static HARAKA_INLINE void run(uint64_t *, const uint64_t *) {}
+};
+
+template <class V, class Tab, unsigned S, unsigned N,
+          bool Done = (S == Packed<V>::steps)>
+struct PackedSteps {
+    static HARAKA_INLINE void run(uint64_t *y)
+    {
+        constexpr unsigned regs = Packed<V>::regs;
+        uint64_t n[N * regs];
+
+        for (unsigned k = 0; k < N; ++k)
+            PackedCols<V, Tab, S / V::aes, S % V::aes, 0>::run(n + k * regs, y + k * regs);
+        for (unsigned i = 0; i < N * regs; ++i)
+            y[i] = n[i];
+        PackedSteps<V, Tab, S + 1, N>::run(y);
+    }
+};
+
+template <class V, class Tab, unsigned S, unsigned N>
+struct PackedSteps<V, Tab, S, N, true> {
+    static HARAKA_INLINE void run(uint64_t *) {}
+};
+
+/* Permutes N states of Packed<V>::regs words in place, state n at
+   y[n * Packed<V>::regs].  Input word w holds lanes (2w, 2w+1); on
+   return word w of the result is y[Packed<V>::out_reg(w)] wherever
+   Packed<V>::out_packed(w). */
+template <class V, class Tab, unsigned N = 1>
+static HARAKA_INLINE void permute_packed(uint64_t *y)
+{
+    PackedSteps<V, Tab, 0, N>::run(y);
+}
+
+} /* namespace haraka */
+
+#endif /* HARAKA_TMPL_H */
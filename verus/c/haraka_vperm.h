@@ -0,0 +1,162 @@
+/*───────────────────────────────────────────────────────────*
+ *  haraka_vperm.h  –  vector-permute (pshufb) Haraka rounds *
+ *                     (C++ only, x86 hosts)                 *
+ *                                                           *
+ *  SubBytes is a nibble split: the low nibble indexes one   *
+ *  16-byte pshufb row per high nibble that holds non-zero   *
+ *  S-box entries, the high nibble masks the row in.  Rows   *
+ *  are derived from SBOX() at compile time, so the VRSC     *
+ *  S-box (24 live entries -> 2 rows) is reproduced exactly  *
+ *  and no data-dependent address is ever formed.            *
+ *                                                           *
+ *  The kernel is generic over a vector traits class `W`     *
+ *  (128-bit SSSE3: one state per register, 256-bit AVX2:    *
+ *  the same block of two states per register) and is        *
+ *  instantiated by haraka_vperm_ssse3.cpp / _avx2.cpp,      *
+ *  which are built with the matching -m flags.              *
+ *───────────────────────────────────────────────────────────*/
+#ifndef HARAKA_VPERM_H
+#define HARAKA_VPERM_H
+
+#ifndef __cplusplus
+#error "haraka_vperm.h requires C++"
+#endif
+
+#include "haraka_tmpl.h"
+#include "haraka_sbox.h"
+
+namespace haraka {
+namespace vperm {
+
+/*──────────────── S-box rows (compile time) ──────────────────────*/
+#define VP_SB(p)   (p)
+static constexpr uint8_t kSbox[256] = SBOX(VP_SB);
+#undef VP_SB
+
+constexpr bool row_live(unsigned h, unsigned i = 0)
+{
+    return i < 16 && (kSbox[16*h + i] != 0 || row_live(h, i + 1));
+}
+
+/* 16-byte constant, kept in rodata and broadcast to every lane */
+struct Row {
+    alignas(16) uint8_t b[16];
+};
+
+struct Rows {
+    Row r[16];
+
+    constexpr Rows() : r()
+    {
+        for (unsigned h = 0; h < 16; ++h)
+            for (unsigned i = 0; i < 16; ++i)
+                r[h].b[i] = kSbox[16*h + i];
+    }
+};
+static constexpr Rows kRows = Rows();
+
+/* pshufb controls: ShiftRows, and the byte rotations inside every
+   column that MixColumns needs (by 1 and by 2 rows) */
+static constexpr Row kShiftRows = {{ 0,  5, 10, 15,  4,  9, 14,  3,
+                                     8, 13,  2,  7, 12,  1,  6, 11 }};
+static constexpr Row kRot1      = {{ 1,  2,  3,  0,  5,  6,  7,  4,
+                                     9, 10, 11,  8, 13, 14, 15, 12 }};
+static constexpr Row kRot2      = {{ 2,  3,  0,  1,  6,  7,  4,  5,
+                                    10, 11,  8,  9, 14, 15, 12, 13 }};
+
+/*──────────────── AES round ─────────────────────────────────────*/
+/* W provides (lane-wise on 16-byte lanes):
+       vec; zero(); set8(byte); splat(const Row &); load_key(16 bytes);
+       shuffle(table, idx) = pshufb; xor_, and_, or_; add8, sub8;
+       addsat8 (unsigned saturating); neg8 (0xff where the byte is
+       >= 0x80); unpacklo32 / unpackhi32                               */
+
+/* Row H looked up for the bytes whose high nibble is H, zero elsewhere:
+   pshufb returns 0 for control bytes with bit 7 set, and after
+   x = a - 16H the saturating x + 0x70 keeps bit 7 clear only for
+   x < 0x10 while leaving the low nibble (the row index) untouched. */
+template <class W, unsigned H>
+static HARAKA_INLINE typename W::vec sub_row(typename W::vec a)
+{
+    const typename W::vec x = H ? W::sub8(a, W::set8((uint8_t)(16*H))) : a;
+
+    return W::shuffle(W::splat(kRows.r[H]), W::addsat8(x, W::set8(0x70)));
+}
+
+template <class W, unsigned H = 0>
+static HARAKA_INLINE typename W::vec sub_bytes(typename W::vec a)
+{
+    if constexpr (H == 15)
+        return row_live(H) ? sub_row<W, H>(a) : W::zero();
+    else if constexpr (row_live(H))
+        return W::or_(sub_row<W, H>(a), sub_bytes<W, H + 1>(a));
+    else
+        return sub_bytes<W, H + 1>(a);
+}
+
+/* SubBytes + ShiftRows + MixColumns (+ AddRoundKey when Key) */
+template <class W, bool Key>
+static HARAKA_INLINE typename W::vec aesenc(typename W::vec a, const uint8_t *key)
+{
+    typedef typename W::vec vec;
+
+    /* bytewise SubBytes commutes with ShiftRows: permute first */
+    const vec s = sub_bytes<W>(W::shuffle(a, W::splat(kShiftRows)));
+
+    /* out_i = 2 s_i ^ 3 s_i+1 ^ s_i+2 ^ s_i+3
+             = xtime(t) ^ s_i+1 ^ rot2(t),  t = s ^ rot1(s) */
+    const vec r1 = W::shuffle(s, W::splat(kRot1));
+    const vec t  = W::xor_(s, r1);
+    const vec xt = W::xor_(W::add8(t, t), W::and_(W::neg8(t), W::set8(0x1b)));
+    vec out = W::xor_(W::xor_(xt, r1), W::shuffle(t, W::splat(kRot2)));
+
+    if (Key)
+        out = W::xor_(out, W::load_key(key));
+    return out;
+}
+
+/*──────────────── MIX (same unpacks as the reference macros) ────*/
+template <class W>
+static HARAKA_INLINE void mix4(typename W::vec *s)
+{
+    typedef typename W::vec vec;
+    const vec tmp = W::unpacklo32(s[0], s[1]);
+    const vec a   = W::unpackhi32(s[0], s[1]);
+    const vec b   = W::unpacklo32(s[2], s[3]);
+    const vec c   = W::unpackhi32(s[2], s[3]);
+
+    s[3] = W::unpacklo32(a, c);
+    s[0] = W::unpackhi32(a, c);
+    s[2] = W::unpackhi32(b, tmp);
+    s[1] = W::unpacklo32(b, tmp);
+}
+
+template <class W>
+static HARAKA_INLINE void mix2(typename W::vec *s)
+{
+    const typename W::vec tmp = W::unpacklo32(s[0], s[1]);
+
+    s[1] = W::unpackhi32(s[0], s[1]);
+    s[0] = tmp;
+}
+
+/*──────────────── permutation ───────────────────────────────────*/
+/* s[b] = block b; round keys come from haraka::kRC */
+template <class W, class V>
+static HARAKA_INLINE void permute(typename W::vec *s)
+{
+    for (unsigned r = 0; r < V::rounds; ++r) {
+        for (unsigned j = 0; j < V::aes; ++j)
+            for (unsigned b = 0; b < V::blocks; ++b)
+                s[b] = aesenc<W, V::keyed>(s[b], kRC[V::rc_index(r, j, b)]);
+        if (V::blocks == 4)
+            mix4<W>(s);
+        else
+            mix2<W>(s);
+    }
+}
+
+} /* namespace vperm */
+} /* namespace haraka */
+
+#endif /* HARAKA_VPERM_H */
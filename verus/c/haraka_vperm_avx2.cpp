@@ -0,0 +1,92 @@
+/*--------------------------------------------------------------------
+ * haraka_vperm_avx2.cpp  –  pshufb Haraka, two states per register
+ *
+ *   Built with -mavx2 on x86 hosts only (see build.sh); the caller
+ *   must make sure the CPU has AVX2.  Block b of state 0 sits in the
+ *   low 128-bit lane and block b of state 1 in the high lane; every
+ *   instruction the kernel uses is lane-local, so one pass hashes two
+ *   inputs.  Results are byte-identical to the scalar portable path.
+ *------------------------------------------------------------------*/
+#include "haraka_x86.h"
+#include "haraka_vperm.h"
+
+#include <immintrin.h>
+
+namespace {
+
+struct W256 {
+    typedef __m256i vec;
+
+    static HARAKA_INLINE vec zero() { return _mm256_setzero_si256(); }
+    static HARAKA_INLINE vec set8(uint8_t b) { return _mm256_set1_epi8((char)b); }
+    static HARAKA_INLINE vec splat(const haraka::vperm::Row &r)
+    {
+        return _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)r.b));
+    }
+    static HARAKA_INLINE vec load_key(const uint8_t *k)
+    {
+        return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)k));
+    }
+    static HARAKA_INLINE vec shuffle(vec t, vec i) { return _mm256_shuffle_epi8(t, i); }
+    static HARAKA_INLINE vec xor_(vec a, vec b) { return _mm256_xor_si256(a, b); }
+    static HARAKA_INLINE vec and_(vec a, vec b) { return _mm256_and_si256(a, b); }
+    static HARAKA_INLINE vec or_(vec a, vec b)  { return _mm256_or_si256(a, b); }
+    static HARAKA_INLINE vec add8(vec a, vec b) { return _mm256_add_epi8(a, b); }
+    static HARAKA_INLINE vec sub8(vec a, vec b) { return _mm256_sub_epi8(a, b); }
+    static HARAKA_INLINE vec addsat8(vec a, vec b) { return _mm256_adds_epu8(a, b); }
+    static HARAKA_INLINE vec neg8(vec a) { return _mm256_cmpgt_epi8(_mm256_setzero_si256(), a); }
+    static HARAKA_INLINE vec unpacklo32(vec a, vec b) { return _mm256_unpacklo_epi32(a, b); }
+    static HARAKA_INLINE vec unpackhi32(vec a, vec b) { return _mm256_unpackhi_epi32(a, b); }
+};
+
+/* block b of the state at p0 (low lane) and p1 (high lane) */
+static HARAKA_INLINE __m256i load2(const uint8_t *p0, const uint8_t *p1)
+{
+    return _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)p0)),
+        _mm_loadu_si128((const __m128i *)p1), 1);
+}
+
+static HARAKA_INLINE void store2(uint8_t *p0, uint8_t *p1, __m256i v)
+{
+    _mm_storeu_si128((__m128i *)p0, _mm256_castsi256_si128(v));
+    _mm_storeu_si128((__m128i *)p1, _mm256_extracti128_si256(v, 1));
+}
+
+/* two 64-byte inputs in, two 32-byte truncated results out */
+template <class V>
+static void perm_trunc_x2(uint8_t *out, const uint8_t *in)
+{
+    __m256i s[4], x[4];
+
+    for (unsigned b = 0; b < 4; ++b)
+        s[b] = x[b] = load2(in + 16*b, in + 64 + 16*b);
+    haraka::vperm::permute<W256, V>(s);
+    for (unsigned b = 0; b < 4; ++b)
+        s[b] = _mm256_xor_si256(s[b], x[b]);
+    store2(out,      out + 32, _mm256_unpackhi_epi64(s[0], s[1]));
+    store2(out + 16, out + 48, _mm256_unpackhi_epi64(s[2], s[3]));
+}
+
+} /* namespace */
+
+void haraka512_vperm_x2(uint8_t *out, const uint8_t *in)
+{
+    perm_trunc_x2<haraka::Haraka512>(out, in);
+}
+
+void haraka512_vperm_zero_x2(uint8_t *out, const uint8_t *in)
+{
+    perm_trunc_x2<haraka::Haraka512Zero>(out, in);
+}
+
+void haraka256_vperm_x2(uint8_t *out, const uint8_t *in)
+{
+    __m256i s[2], x[2];
+
+    for (unsigned b = 0; b < 2; ++b)
+        s[b] = x[b] = load2(in + 16*b, in + 32 + 16*b);
+    haraka::vperm::permute<W256, haraka::Haraka256>(s);
+    for (unsigned b = 0; b < 2; ++b)
+        store2(out + 16*b, out + 32 + 16*b, _mm256_xor_si256(s[b], x[b]));
+}
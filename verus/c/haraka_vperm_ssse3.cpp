@@ -0,0 +1,82 @@
+/*--------------------------------------------------------------------
+ * haraka_vperm_ssse3.cpp  –  pshufb Haraka, one state per register
+ *
+ *   Built with -mssse3 on x86 hosts only (see build.sh); the caller
+ *   must make sure the CPU has SSSE3.  Results are byte-identical to
+ *   haraka512_port / haraka512_port_zero / haraka256_port.
+ *------------------------------------------------------------------*/
+#include "haraka_x86.h"
+#include "haraka_vperm.h"
+
+#include <immintrin.h>
+
+namespace {
+
+struct W128 {
+    typedef __m128i vec;
+
+    static HARAKA_INLINE vec zero() { return _mm_setzero_si128(); }
+    static HARAKA_INLINE vec set8(uint8_t b) { return _mm_set1_epi8((char)b); }
+    static HARAKA_INLINE vec splat(const haraka::vperm::Row &r)
+    {
+        return _mm_load_si128((const __m128i *)r.b);
+    }
+    static HARAKA_INLINE vec load_key(const uint8_t *k)
+    {
+        return _mm_loadu_si128((const __m128i *)k);
+    }
+    static HARAKA_INLINE vec shuffle(vec t, vec i) { return _mm_shuffle_epi8(t, i); }
+    static HARAKA_INLINE vec xor_(vec a, vec b) { return _mm_xor_si128(a, b); }
+    static HARAKA_INLINE vec and_(vec a, vec b) { return _mm_and_si128(a, b); }
+    static HARAKA_INLINE vec or_(vec a, vec b)  { return _mm_or_si128(a, b); }
+    static HARAKA_INLINE vec add8(vec a, vec b) { return _mm_add_epi8(a, b); }
+    static HARAKA_INLINE vec sub8(vec a, vec b) { return _mm_sub_epi8(a, b); }
+    static HARAKA_INLINE vec addsat8(vec a, vec b) { return _mm_adds_epu8(a, b); }
+    static HARAKA_INLINE vec neg8(vec a) { return _mm_cmplt_epi8(a, _mm_setzero_si128()); }
+    static HARAKA_INLINE vec unpacklo32(vec a, vec b) { return _mm_unpacklo_epi32(a, b); }
+    static HARAKA_INLINE vec unpackhi32(vec a, vec b) { return _mm_unpackhi_epi32(a, b); }
+};
+
+template <class V>
+static HARAKA_INLINE void load(__m128i *s, const uint8_t *in)
+{
+    for (unsigned b = 0; b < V::blocks; ++b)
+        s[b] = _mm_loadu_si128((const __m128i *)(in + 16*b));
+}
+
+/* permutation + feed-forward + truncation (bytes 8..15 of each block) */
+template <class V>
+static void perm_trunc(uint8_t *out, const uint8_t *in)
+{
+    __m128i s[4];
+
+    load<V>(s, in);
+    haraka::vperm::permute<W128, V>(s);
+    for (unsigned b = 0; b < 4; ++b)
+        s[b] = _mm_xor_si128(s[b], _mm_loadu_si128((const __m128i *)(in + 16*b)));
+    _mm_storeu_si128((__m128i *)out,        _mm_unpackhi_epi64(s[0], s[1]));
+    _mm_storeu_si128((__m128i *)(out + 16), _mm_unpackhi_epi64(s[2], s[3]));
+}
+
+} /* namespace */
+
+void haraka512_vperm(uint8_t *out, const uint8_t *in)
+{
+    perm_trunc<haraka::Haraka512>(out, in);
+}
+
+void haraka512_vperm_zero(uint8_t *out, const uint8_t *in)
+{
+    perm_trunc<haraka::Haraka512Zero>(out, in);
+}
+
+void haraka256_vperm(uint8_t *out, const uint8_t *in)
+{
+    __m128i s[2];
+
+    load<haraka::Haraka256>(s, in);
+    haraka::vperm::permute<W128, haraka::Haraka256>(s);
+    for (unsigned b = 0; b < 2; ++b)
+        _mm_storeu_si128((__m128i *)(out + 16*b),
+                         _mm_xor_si128(s[b], _mm_loadu_si128((const __m128i *)(in + 16*b))));
+}
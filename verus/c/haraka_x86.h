@@ -0,0 +1,41 @@
+/*───────────────────────────────────────────────────────────*
+ *  haraka_x86.h  –  public API for the x86 host Haraka      *
+ *                   engines (never built for SBF/BPF)       *
+ *───────────────────────────────────────────────────────────*/
+#ifndef HARAKA_X86_H
+#define HARAKA_X86_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* All of these produce exactly what the portable functions of the same
+   name stem produce (haraka512_port, haraka512_port_zero,
+   haraka256_port); the caller must check the ISA before calling. */
+
+/* Vector-permute AES, SSSE3 (haraka_vperm_ssse3.cpp): one state,
+   64-byte (512) / 32-byte (256) input, 32-byte output. */
+void haraka512_vperm(uint8_t *out, const uint8_t *in);
+void haraka512_vperm_zero(uint8_t *out, const uint8_t *in);
+void haraka256_vperm(uint8_t *out, const uint8_t *in);
+
+/* Vector-permute AES, AVX2 (haraka_vperm_avx2.cpp): two states per
+   register.  in = 2 consecutive inputs, out = 2 consecutive 32-byte
+   results. */
+void haraka512_vperm_x2(uint8_t *out, const uint8_t *in);
+void haraka512_vperm_zero_x2(uint8_t *out, const uint8_t *in);
+void haraka256_vperm_x2(uint8_t *out, const uint8_t *in);
+
+/* T-table AES with vpgatherdd, AVX2 (haraka_gather_avx2.cpp): eight
+   states, one 32-bit lane per state column.  in = 8 consecutive inputs,
+   out = 8 consecutive 32-byte results. */
+void haraka512_gather_x8(uint8_t *out, const uint8_t *in);
+void haraka512_gather_zero_x8(uint8_t *out, const uint8_t *in);
+void haraka256_gather_x8(uint8_t *out, const uint8_t *in);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+#endif /* HARAKA_X86_H */
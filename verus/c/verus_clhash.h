@@ -10,46 +10,39 @@
 static const uint64_t CLHASH_K1 = 0x9e3779b185ebca87ULL;
 static const uint64_t CLHASH_K2 = 0xc2b2ae3d27d4eb4fULL;
 
-/* Portable 64x64 carry-less multiplication returning lower 64 bits.
-   This aims to replicate the behavior needed for the VerusHash v2.2 CLHASH step
-   without using PCLMULQDQ intrinsics. */
+/* Lower 64 bits of the 64x64 carry-less (GF(2)) product a*b, as needed
+   for the VerusHash v2.2 CLHASH step.  Portable 4-bit windowed form:
+   tab[i] = a*i, then b is consumed a nibble at a time (Horner, top
+   nibble first).  Bits shifted past bit 63 never reach the low half, so
+   every step may truncate.  16 lookups replace the 96-iteration
+   bit-serial loops; x86 hosts use clmul_mix_pclmul when available
+   (clmul_mix_fn in haraka_dispatch.h). */
 static inline uint64_t clmul_mix(uint64_t a, uint64_t b) {
-    uint64_t a_lo = (uint32_t)a;
-    uint64_t a_hi = a >> 32;
-    uint64_t b_lo = (uint32_t)b;
-    uint64_t b_hi = b >> 32;
-
-    uint64_t p0 = 0, p1 = 0; // p2 (a_hi * b_hi) is not needed for lower 64 bits result
-
-    // Calculate p0 = a_lo * b_lo (lower 64 bits of 128-bit result)
-    // Uses simple shift-and-xor loop for GF(2) multiplication
-    uint64_t x = a_lo;
-    for (int i = 0; i < 32; ++i) {
-        if ((b_lo >> i) & 1) {
-            p0 ^= (x << i);
-        }
+    uint64_t tab[16];
+    tab[0] = 0;
+    tab[1] = a;
+    for (int i = 2; i < 16; i += 2) {
+        tab[i]     = tab[i >> 1] << 1;
+        tab[i + 1] = tab[i] ^ a;
     }
 
-    // Calculate p1 = a_lo * b_hi + a_hi * b_lo
-    uint64_t t1 = 0;
-    x = a_lo;
-    for (int i = 0; i < 32; ++i) {
-        if ((b_hi >> i) & 1) {
-            t1 ^= (x << i);
-        }
-    }
-    uint64_t t2 = 0;
-    x = a_hi;
-    for (int i = 0; i < 32; ++i) {
-        if ((b_lo >> i) & 1) {
-            t2 ^= (x << i);
-        }
-    }
-    p1 = t1 ^ t2;
+    uint64_t r = 0;
+    for (int i = 60; i >= 0; i -= 4)
+        r = (r << 4) ^ tab[(b >> i) & 15];
+    return r;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Same result with PCLMULQDQ (clmul_pclmul.cpp, x86 hosts only); the
+   caller must check the CPU. */
+uint64_t clmul_mix_pclmul(uint64_t a, uint64_t b);
 
-    // Combine results for lower 64 bits: result_lo64 = (p1 << 32) ^ p0
-    return (p1 << 32) ^ p0;
+#ifdef __cplusplus
 }
+#endif
 
 #endif /* VERUS_CLHASH_H */
 
@@ -1,6 +1,7 @@
 #include <stdint.h>
 #include "verus_hash.h"
 #include "haraka_portable.h" // Includes verus_memcpy/verus_memset declarations
+#include "haraka_dispatch.h" // Fastest bit-exact Haraka engine for this CPU
 #include "uint256.h"
 #include "common.h" // Includes stddef.h for size_t
 #include "verus_clhash.h" // Include CLHASH definitions for v2.2
@@ -17,7 +18,7 @@
 #endif /* __clang__ && __ELF__ */
 
 /* ---- Full VerusHash 1.0 Implementation ---- */
-// Based on CVerusHash::Hash from origin-impl, using haraka512_port_zero
+// Based on CVerusHash::Hash from origin-impl, using haraka512_zero_fn
 
 void verus_hash(unsigned char *result, const unsigned char *data, size_t len)
 {
@@ -47,7 +48,7 @@ void verus_hash(unsigned char *result, const unsigned char *data, size_t len)
             verus_memset(bufPtr + 32 + i, 0, 32 - i);
         }
         // Apply the Haraka-512 permutation with zero constants
-        haraka512_port_zero(bufPtr2, bufPtr);
+        haraka512_zero_fn(bufPtr2, bufPtr);
 
         // Swap buffer pointers for the next round
         bufPtr2 = bufPtr;
@@ -59,50 +60,126 @@ void verus_hash(unsigned char *result, const unsigned char *data, size_t len)
 }
 
 
+/* ---- Batched VerusHash 1.0 ---- */
+// Runs n independent messages through the v1 sponge in lockstep, four at
+// a time through haraka512_zero_x4_fn.  Slot s owns the 64-byte Haraka
+// input blk[s] = state || block; when its message is fully absorbed the
+// hash is written out and the slot takes the next message, so unequal
+// lengths never stall the batch.  out receives n consecutive 32-byte
+// hashes, identical to verus_hash().
+void verus_hash_v1_batch(unsigned char *out, const unsigned char *const *in,
+                         const size_t *len, size_t n)
+{
+    enum { SLOTS = 4 };
+    unsigned char blk[SLOTS * 64];
+    unsigned char res[SLOTS * 32];
+    size_t msg[SLOTS], pos[SLOTS];
+    bool busy[SLOTS] = { false, false, false, false };
+    size_t next = 0;
+
+    for (;;) {
+        int live = 0;
+
+        for (int s = 0; s < SLOTS; ++s) {
+            unsigned char *b = blk + 64 * s;
+
+            // Refill an idle slot; an empty message hashes to the zero state
+            while (!busy[s] && next < n) {
+                if (len[next] == 0) {
+                    verus_memset(out + 32 * next, 0, 32);
+                    ++next;
+                    continue;
+                }
+                verus_memset(b, 0, 32);
+                msg[s] = next++;
+                pos[s] = 0;
+                busy[s] = true;
+            }
+            if (!busy[s])
+                continue;
+
+            // Next 32 bytes of the message, zero padded
+            size_t rest = len[msg[s]] - pos[s];
+            size_t take = rest < 32 ? rest : 32;
+            verus_memcpy(b + 32, in[msg[s]] + pos[s], take);
+            if (take < 32)
+                verus_memset(b + 32 + take, 0, 32 - take);
+            ++live;
+        }
+        if (live == 0)
+            break;
+
+        if (live == SLOTS)
+            haraka512_zero_x4_fn(res, blk);
+        else
+            for (int s = 0; s < SLOTS; ++s)
+                if (busy[s])
+                    haraka512_zero_fn(res + 32 * s, blk + 64 * s);
+
+        for (int s = 0; s < SLOTS; ++s) {
+            if (!busy[s])
+                continue;
+            pos[s] += 32;
+            if (pos[s] >= len[msg[s]]) {
+                verus_memcpy(out + 32 * msg[s], res + 32 * s, 32);
+                busy[s] = false;
+            } else {
+                verus_memcpy(blk + 64 * s, res + 32 * s, 32);
+            }
+        }
+    }
+}
+
 /* ---- Full VerusHash 2.2 Implementation ---- */
-// Renamed from verus_hash_v2 to avoid conflict with V2.0 needed for tests/FFI
-void verus_hash_v2_2(unsigned char *out, const unsigned char *in, size_t len)
+
+// Sponge state (consensus): haraka512_fn writes 32 bytes, so the
+// feed-forward after each block covers S[0..32] only, S[32..64] holds
+// nothing but the padding, and after the final permutation the state is
+// its 32-byte output with a zero upper half.  The original code XORed
+// and copied 64 bytes of a buffer whose upper half Haraka-512 never
+// wrote, so every message of 32 bytes or more hashed to whatever the
+// stack held; the rule here is that code with the buffer zeroed.  Every
+// path below (single, fixed length, batch, search, midstate, streaming)
+// follows it, and the verus_hash_v2_pinned test in verus/src/lib.rs pins
+// the resulting hashes.
+static inline void v2_2_feed_forward(uint8_t S[64], const uint8_t st[32])
 {
-    /* ------------- Sponge over Haraka-512 ------------- */
-    uint8_t S[64] = {0}, tmp[64]; // Initialize state S to zeros
-    size_t i = 0;
-    while (i + 32 <= len) {                    /* absorb full 32-byte blocks */
-        for (int j=0;j<32;++j) S[j] ^= in[i+j]; // XOR input block into the first 32 bytes of state
-        haraka512_port(tmp, S);                // Apply Haraka-512 permutation to state S -> tmp
-        // The reference code seems to use a simple permutation update, not XOR feed-forward here.
-        // Let's follow the provided code block exactly for the sponge part.
-        // Original provided code: for (int j=0;j<64;++j) S[j] ^= tmp[j]; /* feed-forward */
-        // Let's stick to the provided code block:
-        // Restore the original feed-forward XOR step to match reference implementation
-        for (int j=0;j<64;++j) S[j] ^= tmp[j]; // XOR feed-forward
-        i += 32;
+    for (int j=0;j<32;++j) S[j] ^= st[j];
+}
+
+// Absorbs `nblocks` full 32-byte blocks into the sponge state S.
+static inline void v2_2_absorb(uint8_t S[64], const unsigned char *in, size_t nblocks)
+{
+    uint8_t tmp[32];
+    for (size_t b = 0; b < nblocks; ++b, in += 32) {
+        for (int j=0;j<32;++j) S[j] ^= in[j]; // XOR input block into the first 32 bytes of state
+        haraka512_fn(tmp, S);                  // Apply Haraka-512 permutation to state S -> tmp
+        v2_2_feed_forward(S, tmp);
     }
+}
 
-    /* absorb last partial block + 10* padding */
+// Absorbs the last `remaining` (< 32) bytes of the message with 10*
+// padding; the final permutation follows.
+static inline void v2_2_pad(uint8_t S[64], const unsigned char *tail, size_t remaining)
+{
     // XOR in remaining bytes
-    size_t remaining = len - i;
     for(size_t j=0; j<remaining; ++j) {
-        S[j] ^= in[i+j]; // XOR into the start of the state buffer
+        S[j] ^= tail[j]; // XOR into the start of the state buffer
     }
     // Apply padding: XOR 0x01 at the position after the last byte
     S[remaining] ^= 0x01;
     // XOR 0x80 into the last byte of the 64-byte state
     S[63] ^= 0x80;
+}
 
-    // Final permutation after padding
-    haraka512_port(tmp, S);
-    // Update state S with the final permuted output
-    for (int j=0;j<64;++j) S[j] = tmp[j];
-
-
-    /* ------------- CLHASH mix (first 64 bytes of input) ------------- */
-    // uint64_t *s64 = (uint64_t*)S; // Removed: No longer used, access via verus_memcpy
+// CLHASH mix of `block` (the first 64 message bytes, zero padded) into
+// the 32-byte output `st` of the final permutation.  The state beyond
+// those 32 bytes is zero, and Haraka-256 only reads st, so lanes 4..7
+// use a zero state lane and take no mix back.
+static inline void v2_2_clhash(uint8_t st[32], const uint8_t block[64])
+{
     uint64_t k1 = CLHASH_K1, k2 = CLHASH_K2;
     uint64_t mix = 0;
-    uint8_t block[64]; // Buffer for the first 64 bytes of input (or less, padded)
-    verus_memset(block, 0, 64); // Zero initialize block for padding
-    size_t cpy = len < 64 ? len : 64;
-    verus_memcpy(block, in, cpy); // Copy up to 64 bytes from original input
 
     // Mix each 64-bit lane of the input block with the corresponding state lane
     for (int lane=0; lane<8; ++lane) {
@@ -110,32 +187,448 @@ void verus_hash_v2_2(unsigned char *out, const unsigned char *in, size_t len)
         // Safely read 8 bytes from block into m
         verus_memcpy(&m, &block[lane * 8], sizeof(uint64_t));
 
-        uint64_t s_lane; // State lane
-        // Safely read 8 bytes from S (state) into s_lane
-        verus_memcpy(&s_lane, &S[lane * 8], sizeof(uint64_t));
+        uint64_t s_lane = 0; // State lane (lanes 4..7 are zero)
+        // Safely read 8 bytes from the state into s_lane
+        if (lane < 4)
+            verus_memcpy(&s_lane, &st[lane * 8], sizeof(uint64_t));
 
         uint64_t p = (lane&1) ? k2 : k1;       // Select CLHASH key based on lane
         // clmul_mix(key ^ state_lane, input_lane)
-        mix ^= clmul_mix(p ^ s_lane, m);
+        mix ^= clmul_mix_fn(p ^ s_lane, m);
     }
-    // XOR the final mix value back into each lane of the state
-    for (int lane=0; lane<8; ++lane) {
+    // XOR the final mix value back into the lanes Haraka-256 reads (0..3)
+    for (int lane=0; lane<4; ++lane) {
         uint64_t s_lane;
-        // Safely read 8 bytes from S into s_lane
-        verus_memcpy(&s_lane, &S[lane * 8], sizeof(uint64_t));
+        // Safely read 8 bytes from the state into s_lane
+        verus_memcpy(&s_lane, &st[lane * 8], sizeof(uint64_t));
         s_lane ^= mix; // Apply the mix to the local variable
-        // Safely write the modified 8 bytes back to S
-        verus_memcpy(&S[lane * 8], &s_lane, sizeof(uint64_t));
+        // Safely write the modified 8 bytes back
+        verus_memcpy(&st[lane * 8], &s_lane, sizeof(uint64_t));
     }
+}
+
+// Big-endian Haraka-256 output F to the little-endian hash
+static inline void v2_2_store_le(unsigned char *out, const uint8_t F[32])
+{
+    for (int j=0;j<32;++j) out[j] = F[31-j];   /* LE */
+}
+
+// Absorbs the last `remaining` (< 32) bytes with 10* padding, then the
+// CLHASH mix of `block` (the first 64 message bytes, zero padded) and the
+// final Haraka-256.  Writes the LE hash to `out`.
+static inline void v2_2_final(unsigned char *out, uint8_t S[64], const unsigned char *tail,
+                              size_t remaining, const uint8_t block[64])
+{
+    uint8_t st[32], F[32];
+
+    /* absorb last partial block + 10* padding */
+    v2_2_pad(S, tail, remaining);
+    // Final permutation after padding; its 32-byte output is the state
+    haraka512_fn(st, S);
+
+    /* ------------- CLHASH mix (first 64 bytes of input) ------------- */
+    v2_2_clhash(st, block);
 
     /* ------------- Final Haraka-256 ------------- */
-    uint8_t F[32]; // Buffer for final hash output
-    // Hash the first 32 bytes of the mixed state S using Haraka-256
-    // Note: Haraka-256 takes the first 32 bytes of S as input.
-    haraka256_port(F, S);              /* BE output */
+    haraka256_fn(F, st);               /* BE output */
+    v2_2_store_le(out, F);
+}
 
-    // Convert final hash F (Big-Endian) to Little-Endian for output `out`
-    for (int j=0;j<32;++j) out[j] = F[31-j];   /* LE */
+// VerusHash v2.2 of exactly Len bytes.  The block count, the padding
+// positions and the tail are compile-time constants, and from 64 bytes
+// on the CLHASH block is read straight from the input instead of a
+// zero-filled copy.
+template <size_t Len>
+static inline void v2_2_fixed(unsigned char *out, const unsigned char *in)
+{
+    uint8_t S[64] = {0};
+    v2_2_absorb(S, in, Len / 32);
+
+    if (Len >= 64) {
+        v2_2_final(out, S, in + (Len & ~(size_t)31), Len & 31, in);
+    } else {
+        uint8_t block[64] = {0};
+        verus_memcpy(block, in, Len);
+        v2_2_final(out, S, in + (Len & ~(size_t)31), Len & 31, block);
+    }
+}
+
+// 64 bytes: challenge || signer[0..24] || nonce, the size of every
+// on-chain verification and every client nonce.
+void verus_hash_v2_2_64(unsigned char *out, const unsigned char *in)
+{
+    v2_2_fixed<64>(out, in);
+}
+
+// Renamed from verus_hash_v2 to avoid conflict with V2.0 needed for tests/FFI
+void verus_hash_v2_2(unsigned char *out, const unsigned char *in, size_t len)
+{
+    if (len == 64) {
+        verus_hash_v2_2_64(out, in);
+        return;
+    }
+
+    /* ------------- Sponge over Haraka-512 ------------- */
+    uint8_t S[64] = {0}; // Initialize state S to zeros
+    v2_2_absorb(S, in, len / 32);               /* absorb full 32-byte blocks */
+
+    uint8_t block[64]; // Buffer for the first 64 bytes of input (or less, padded)
+    verus_memset(block, 0, 64); // Zero initialize block for padding
+    size_t cpy = len < 64 ? len : 64;
+    verus_memcpy(block, in, cpy); // Copy up to 64 bytes from original input
+
+    v2_2_final(out, S, in + (len & ~(size_t)31), len & 31, block);
+}
+
+/* ---- Strided batches ---- */
+// `count` messages of `len` bytes each, `stride` bytes apart, hashed four
+// at a time in lockstep through the _x4 Haraka kernels (the widest engine
+// haraka_dispatch.h picked); a remainder of up to three messages goes
+// through the single-message path.  out receives `count` consecutive
+// 32-byte hashes.
+
+// Four v2.2 sponges in lockstep: absorbs msg[k][from..len) into the
+// states S (which already hold msg[k][0..from), `from` a multiple of 32),
+// then pads and finishes.  F receives the four big-endian Haraka-256
+// outputs.
+static void v2_2_x4(uint8_t F[4 * 32], uint8_t S[4 * 64],
+                    const unsigned char *const msg[4], size_t from, size_t len)
+{
+    const size_t rest = len & 31, tail = len & ~(size_t)31;
+    uint8_t st[4 * 32];
+
+    for (size_t pos = from; pos < tail; pos += 32) {
+        for (int k = 0; k < 4; ++k)
+            for (int j = 0; j < 32; ++j)
+                S[64 * k + j] ^= msg[k][pos + j];
+        haraka512_x4_fn(st, S);
+        for (int k = 0; k < 4; ++k)
+            v2_2_feed_forward(S + 64 * k, st + 32 * k);
+    }
+
+    for (int k = 0; k < 4; ++k)
+        v2_2_pad(S + 64 * k, msg[k] + tail, rest);
+    haraka512_x4_fn(st, S);
+
+    for (int k = 0; k < 4; ++k) {
+        if (len >= 64) {
+            v2_2_clhash(st + 32 * k, msg[k]);
+        } else {
+            uint8_t block[64];
+            verus_memset(block, 0, 64);
+            verus_memcpy(block, msg[k], len);
+            v2_2_clhash(st + 32 * k, block);
+        }
+    }
+
+    haraka256_x4_fn(F, st);
+}
+
+void verus_hash_v2_2_batch(unsigned char *out, const unsigned char *in,
+                           size_t stride, size_t len, size_t count)
+{
+    size_t n = 0;
+
+    for ( ; n + 4 <= count; n += 4) {
+        const unsigned char *msg[4];
+        uint8_t S[4 * 64], F[4 * 32];
+        for (int k = 0; k < 4; ++k)
+            msg[k] = in + (n + k) * stride;
+        verus_memset(S, 0, sizeof(S));
+
+        v2_2_x4(F, S, msg, 0, len);
+        for (int k = 0; k < 4; ++k)
+            v2_2_store_le(out + 32 * (n + k), F + 32 * k);
+    }
+
+    for ( ; n < count; ++n)
+        verus_hash_v2_2(out + 32 * n, in + n * stride, len);
+}
+
+void verus_hash_batch(unsigned char *out, const unsigned char *in,
+                      size_t stride, size_t len, size_t count)
+{
+    size_t n = 0;
+
+    for ( ; n + 4 <= count; n += 4) {
+        const unsigned char *msg = in + n * stride;
+        unsigned char buf[4 * 64], res[4 * 32];
+        verus_memset(buf, 0, sizeof(buf));
+        verus_memset(res, 0, sizeof(res)); // the hash of an empty message
+
+        for (size_t pos = 0; pos < len; pos += 32) {
+            const size_t take = len - pos < 32 ? len - pos : 32;
+            for (int k = 0; k < 4; ++k) {
+                unsigned char *b = buf + 64 * k;
+                verus_memcpy(b + 32, msg + k * stride + pos, take);
+                if (take < 32)
+                    verus_memset(b + 32 + take, 0, 32 - take);
+            }
+            haraka512_zero_x4_fn(res, buf);
+            for (int k = 0; k < 4; ++k)
+                verus_memcpy(buf + 64 * k, res + 32 * k, 32);
+        }
+        verus_memcpy(out + 32 * n, res, sizeof(res));
+    }
+
+    for ( ; n < count; ++n)
+        verus_hash(out + 32 * n, in + n * stride, len);
+}
+
+/* ---- Nonce search ---- */
+// Four copies of the template run through v2_2_x4(), each with its own
+// 8-byte little-endian nonce that is bumped by 4 in place per round.  The
+// blocks in front of the nonce are absorbed once.  Haraka-256 output is
+// already the big-endian hash, so it is compared with the target as four
+// big-endian words, most significant first; nearly every try is decided
+// by the first word.
+
+static inline uint64_t load_be64(const uint8_t *p)
+{
+    uint64_t w = 0;
+    for (int j = 0; j < 8; ++j) w = (w << 8) | p[j];
+    return w;
+}
+
+// hash_be <= target
+static inline bool v2_2_meets(const uint8_t hash_be[32], const uint64_t target[4])
+{
+    for (int i = 0; i < 4; ++i) {
+        const uint64_t w = load_be64(hash_be + 8 * i);
+        if (w != target[i])
+            return w < target[i];
+    }
+    return true;
+}
+
+// Little-endian p[0..8) += add, wrapping
+static inline void nonce_add(unsigned char *p, unsigned add)
+{
+    for (int j = 0; j < 8 && add; ++j) {
+        add += p[j];
+        p[j] = (unsigned char)add;
+        add >>= 8;
+    }
+}
+
+int verus_search_v2_2(const unsigned char *tmpl, size_t len, size_t nonce_offset,
+                      uint64_t start, uint64_t count, const unsigned char *target,
+                      uint64_t *found)
+{
+    if (len > VERUS_SEARCH_MAX_LEN || nonce_offset > len || len - nonce_offset < 8)
+        return -1;
+
+    uint64_t t[4];
+    for (int i = 0; i < 4; ++i)
+        t[i] = load_be64(target + 8 * i);
+
+    // Every block before the one holding the nonce's first byte is shared
+    const size_t from = nonce_offset & ~(size_t)31;
+    uint8_t S0[64];
+    verus_memset(S0, 0, sizeof(S0));
+    v2_2_absorb(S0, tmpl, from / 32);
+
+    unsigned char buf[4][VERUS_SEARCH_MAX_LEN];
+    const unsigned char *msg[4];
+    for (int k = 0; k < 4; ++k) {
+        const uint64_t nonce = start + (uint64_t)k;
+        verus_memcpy(buf[k], tmpl, len);
+        for (int j = 0; j < 8; ++j)
+            buf[k][nonce_offset + j] = (unsigned char)(nonce >> (8 * j));
+        msg[k] = buf[k];
+    }
+
+    for (uint64_t done = 0; done < count; ) {
+        uint8_t S[4 * 64], F[4 * 32];
+        for (int k = 0; k < 4; ++k)
+            verus_memcpy(S + 64 * k, S0, 64);
+
+        v2_2_x4(F, S, msg, from, len);
+
+        const uint64_t lanes = count - done < 4 ? count - done : 4;
+        for (uint64_t k = 0; k < lanes; ++k) {
+            if (v2_2_meets(F + 32 * k, t)) {
+                *found = start + done + k;
+                return 1;
+            }
+        }
+        done += lanes;
+
+        for (int k = 0; k < 4; ++k)
+            nonce_add(buf[k] + nonce_offset, 4);
+    }
+    return 0;
+}
+
+/* ---- Midstates ---- */
+// Serialized layout (VERUS_MIDSTATE_SIZE bytes, little endian):
+//   [0]        version tag: 0x01 (v1) or 0x22 (v2.2); [1..8) zero
+//   [8..16)    bytes absorbed so far, a multiple of 32
+//   [16..80)   sponge state (v1 uses the first 32 bytes)
+//   [80..144)  v2.2: first 64 message bytes seen so far (CLHASH block)
+#define MID_TAG   0
+#define MID_LEN   8
+#define MID_STATE 16
+#define MID_HEAD  80
+
+static uint64_t mid_len(const unsigned char *mid)
+{
+    uint64_t n = 0;
+    for (int j = 7; j >= 0; --j) n = (n << 8) | mid[MID_LEN + j];
+    return n;
+}
+
+static void mid_set_len(unsigned char *mid, uint64_t n)
+{
+    for (int j = 0; j < 8; ++j) mid[MID_LEN + j] = (unsigned char)(n >> (8 * j));
+}
+
+// v1 sponge over `nblocks` full blocks: state = Haraka512-zero(state || block)
+static void v1_absorb(unsigned char st[32], const unsigned char *in, size_t nblocks)
+{
+    unsigned char buf[64];
+    for (size_t b = 0; b < nblocks; ++b, in += 32) {
+        verus_memcpy(buf, st, 32);
+        verus_memcpy(buf + 32, in, 32);
+        haraka512_zero_fn(st, buf);
+    }
+}
+
+int verus_midstate_check(const unsigned char *mid)
+{
+    if (mid[MID_TAG] != VERUS_MIDSTATE_V1 && mid[MID_TAG] != VERUS_MIDSTATE_V2_2)
+        return -1;
+    for (int j = 1; j < MID_LEN; ++j)
+        if (mid[j])
+            return -1;
+    return (mid_len(mid) & 31) ? -1 : 0;
+}
+
+int verus_midstate_init(unsigned char *mid, int version,
+                        const unsigned char *prefix, size_t len)
+{
+    if (version != VERUS_MIDSTATE_V1 && version != VERUS_MIDSTATE_V2_2)
+        return -1;
+    verus_memset(mid, 0, VERUS_MIDSTATE_SIZE);
+    mid[MID_TAG] = (unsigned char)version;
+    return verus_midstate_absorb(mid, prefix, len);
+}
+
+int verus_midstate_absorb(unsigned char *mid, const unsigned char *data, size_t len)
+{
+    if (verus_midstate_check(mid) || (len & 31))
+        return -1;
+
+    uint64_t done = mid_len(mid);
+    if (mid[MID_TAG] == VERUS_MIDSTATE_V1) {
+        v1_absorb(mid + MID_STATE, data, len / 32);
+    } else {
+        if (done < 64) {
+            size_t cpy = len < 64 - done ? len : (size_t)(64 - done);
+            verus_memcpy(mid + MID_HEAD + done, data, cpy);
+        }
+        v2_2_absorb(mid + MID_STATE, data, len / 32);
+    }
+    mid_set_len(mid, done + len);
+    return 0;
+}
+
+int verus_midstate_finish(unsigned char *out, const unsigned char *mid,
+                          const unsigned char *suffix, size_t len)
+{
+    if (verus_midstate_check(mid))
+        return -1;
+
+    const uint64_t done = mid_len(mid);
+    const size_t full = len & ~(size_t)31, rest = len & 31;
+
+    if (mid[MID_TAG] == VERUS_MIDSTATE_V1) {
+        // Same as verus_hash(): whole blocks, then one zero-padded block
+        unsigned char st[32], buf[64];
+        verus_memcpy(st, mid + MID_STATE, 32);
+        v1_absorb(st, suffix, full / 32);
+        if (rest) {
+            verus_memcpy(buf, st, 32);
+            verus_memcpy(buf + 32, suffix + full, rest);
+            verus_memset(buf + 32 + rest, 0, 32 - rest);
+            haraka512_zero_fn(st, buf);
+        }
+        verus_memcpy(out, st, 32);
+        return 0;
+    }
+
+    uint8_t S[64], block[64];
+    verus_memcpy(S, mid + MID_STATE, 64);
+    verus_memcpy(block, mid + MID_HEAD, 64);
+    if (done < 64) {
+        size_t cpy = len < 64 - done ? len : (size_t)(64 - done);
+        verus_memcpy(block + done, suffix, cpy);
+    }
+    v2_2_absorb(S, suffix, full / 32);
+    v2_2_final(out, S, suffix + full, rest, block);
+    return 0;
+}
+
+/* ---- Streaming ---- */
+// Whole 32-byte blocks go straight into the midstate; the tail of each
+// update waits in ctx->buf until a block is complete or final() pads it.
+
+static void ctx_init(verus_hash_ctx *ctx, int version)
+{
+    verus_midstate_init(ctx->mid, version, ctx->buf, 0);
+    verus_memset(ctx->buf, 0, sizeof(ctx->buf));
+    ctx->buffered = 0;
+}
+
+static void ctx_update(verus_hash_ctx *ctx, const unsigned char *data, size_t len)
+{
+    if (ctx->buffered) {
+        size_t take = 32 - ctx->buffered < len ? 32 - ctx->buffered : len;
+        verus_memcpy(ctx->buf + ctx->buffered, data, take);
+        ctx->buffered += take;
+        data += take;
+        len -= take;
+        if (ctx->buffered < 32)
+            return;
+        verus_midstate_absorb(ctx->mid, ctx->buf, 32);
+        ctx->buffered = 0;
+    }
+
+    const size_t full = len & ~(size_t)31;
+    if (full)
+        verus_midstate_absorb(ctx->mid, data, full);
+    verus_memcpy(ctx->buf, data + full, len - full);
+    ctx->buffered = len - full;
+}
+
+void verus_v1_init(verus_hash_ctx *ctx)
+{
+    ctx_init(ctx, VERUS_MIDSTATE_V1);
+}
+
+void verus_v1_update(verus_hash_ctx *ctx, const unsigned char *data, size_t len)
+{
+    ctx_update(ctx, data, len);
+}
+
+void verus_v1_final(const verus_hash_ctx *ctx, unsigned char *out)
+{
+    verus_midstate_finish(out, ctx->mid, ctx->buf, ctx->buffered);
+}
+
+void verus_v2_2_init(verus_hash_ctx *ctx)
+{
+    ctx_init(ctx, VERUS_MIDSTATE_V2_2);
+}
+
+void verus_v2_2_update(verus_hash_ctx *ctx, const unsigned char *data, size_t len)
+{
+    ctx_update(ctx, data, len);
+}
+
+void verus_v2_2_final(const verus_hash_ctx *ctx, unsigned char *out)
+{
+    verus_midstate_finish(out, ctx->mid, ctx->buf, ctx->buffered);
 }
 
 /* Initialization function is no longer needed. */
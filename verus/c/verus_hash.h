@@ -11,10 +11,89 @@ extern "C" {
 // Implements VerusHash v1 algorithm (Haraka512-Zero + Sponge).
 void verus_hash(unsigned char *out, const unsigned char *in, size_t len);
 
+// VerusHash v1 of n independent messages in[i] (len[i] bytes each), run
+// through the sponge in lockstep.  out receives n consecutive 32-byte
+// hashes, identical to calling verus_hash() on each message.
+void verus_hash_v1_batch(unsigned char *out, const unsigned char *const *in,
+                         const size_t *len, size_t n);
+
 // Hashes input `in` of length `len` into `out` (32 bytes).
-// Implements VerusHash v2.2 algorithm.
+// Implements VerusHash v2.2 algorithm.  The sponge feeds forward only the
+// 32 bytes Haraka-512 writes (see verus_hash.cpp); hashes of 32 bytes and
+// more differ from builds that fed forward 64 bytes of stack.
 void verus_hash_v2_2(unsigned char *out, const unsigned char *in, size_t len);
 
+// verus_hash_v2_2() specialized for a fixed length (loops, padding and
+// the CLHASH block resolved at compile time).  verus_hash_v2_2() uses
+// them automatically when the length matches.
+void verus_hash_v2_2_64(unsigned char *out, const unsigned char *in);
+
+// `count` messages of `len` bytes, `stride` bytes apart (message i at
+// in + i * stride), hashed in lockstep with the widest Haraka batch
+// kernel available.  out receives `count` consecutive 32-byte hashes,
+// identical to verus_hash_v2_2() / verus_hash() on each message.
+void verus_hash_v2_2_batch(unsigned char *out, const unsigned char *in,
+                           size_t stride, size_t len, size_t count);
+void verus_hash_batch(unsigned char *out, const unsigned char *in,
+                      size_t stride, size_t len, size_t count);
+
+// Nonce search: hashes (v2.2) copies of the `len`-byte template `tmpl`
+// whose 8 bytes at `nonce_offset` hold the little-endian nonces start,
+// start + 1, ... (wrapping), `count` of them, and stops at the first one
+// whose big-endian hash is <= the big-endian `target` (32 bytes).
+// Returns 1 with that nonce in *found, 0 if none of the `count` hit, or
+// -1 if the nonce does not fit in the template or
+// len > VERUS_SEARCH_MAX_LEN.
+#define VERUS_SEARCH_MAX_LEN 256
+
+int verus_search_v2_2(const unsigned char *tmpl, size_t len, size_t nonce_offset,
+                      uint64_t start, uint64_t count, const unsigned char *target,
+                      uint64_t *found);
+
+// Midstates: a sponge with a fixed prefix already absorbed, serialized
+// into VERUS_MIDSTATE_SIZE opaque bytes.  Finishing a midstate with a
+// suffix gives the same hash as verus_hash() / verus_hash_v2_2() over
+// prefix || suffix.  Prefixes are absorbed at 32-byte boundaries.
+#define VERUS_MIDSTATE_SIZE 144
+#define VERUS_MIDSTATE_V1   0x01
+#define VERUS_MIDSTATE_V2_2 0x22
+
+// Starts `mid` for `version` and absorbs `prefix`; `len` must be a
+// multiple of 32.  Returns 0, or -1 on a bad version or length.
+int verus_midstate_init(unsigned char *mid, int version,
+                        const unsigned char *prefix, size_t len);
+
+// Absorbs `len` more bytes (a multiple of 32) into `mid`.
+// Returns 0, or -1 on a bad length or malformed midstate.
+int verus_midstate_absorb(unsigned char *mid, const unsigned char *data, size_t len);
+
+// Hashes prefix || suffix into `out` (32 bytes); `mid` is not modified.
+// Returns 0, or -1 on a malformed midstate.
+int verus_midstate_finish(unsigned char *out, const unsigned char *mid,
+                          const unsigned char *suffix, size_t len);
+
+// Returns 0 if `mid` is a well-formed serialized midstate, else -1.
+int verus_midstate_check(const unsigned char *mid);
+
+// Streaming hashers: the message is fed to update() in pieces of any
+// size; final() writes the same hash as verus_hash() / verus_hash_v2_2()
+// over the concatenation.  The context is a midstate plus up to 31
+// buffered bytes and holds no pointers; final() does not modify it, so
+// more data may follow.
+typedef struct verus_hash_ctx {
+    unsigned char mid[VERUS_MIDSTATE_SIZE];
+    unsigned char buf[32];
+    size_t buffered;
+} verus_hash_ctx;
+
+void verus_v1_init(verus_hash_ctx *ctx);
+void verus_v1_update(verus_hash_ctx *ctx, const unsigned char *data, size_t len);
+void verus_v1_final(const verus_hash_ctx *ctx, unsigned char *out);
+
+void verus_v2_2_init(verus_hash_ctx *ctx);
+void verus_v2_2_update(verus_hash_ctx *ctx, const unsigned char *data, size_t len);
+void verus_v2_2_final(const verus_hash_ctx *ctx, unsigned char *out);
+
 // Implements VerusHash v2.0 algorithm (Sponge only).
 void verus_hash_v2(unsigned char *out, const unsigned char *in, size_t len);
 
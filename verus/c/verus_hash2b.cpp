@@ -0,0 +1,207 @@
+/*--------------------------------------------------------------------
+ * verus_hash2b.cpp  –  full VerusHash 2.2 (Finalize2b), portable
+ *                      engine, per-thread key cache and dispatch
+ *
+ *   Host builds only (see build.sh): the 17 KiB key state is
+ *   thread-local unless the caller passes its own.  The stages
+ *   themselves are verus_hash2b_tmpl.h; this file supplies a portable
+ *   128-bit backend for them:
+ *
+ *     aesenc      real AES round from four T-tables built at compile
+ *                 time from sbox.inc
+ *     clmul_lohi  4-bit windowed 64x64 carry-less product, both halves
+ *     mulhrs      eight 16-bit lanes
+ *
+ *   On x86 the AES-NI engine (verus_hash2b_aesni.cpp) is picked by
+ *   IsCPUVerusOptimized() from haraka_dispatch.
+ *------------------------------------------------------------------*/
+#include "verus_hash2b.h"
+#include "verus_hash2b_tmpl.h"
+#include "haraka_dispatch.h"
+#include "haraka_sbox.h"          /* F2 / F3 / B2W / U0..U3 */
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+/*---------------- real AES T-tables --------------------------------*/
+static constexpr uint8_t kSbox[256] = {
+#include "sbox.inc"
+};
+
+struct AesTables {
+    uint32_t t[4][256];
+
+    constexpr AesTables() : t()
+    {
+        for (unsigned i = 0; i < 256; ++i) {
+            const uint32_t p = kSbox[i];
+            t[0][i] = U0(p);
+            t[1][i] = U1(p);
+            t[2][i] = U2(p);
+            t[3][i] = U3(p);
+        }
+    }
+};
+
+static constexpr AesTables kAes;
+
+/*---------------- portable backend ---------------------------------*/
+struct Port {
+    struct V { uint64_t lo, hi; };
+
+    static V2B_INLINE V load(const uint8_t *p)
+    {
+        V v;
+        memcpy(&v.lo, p, 8);
+        memcpy(&v.hi, p + 8, 8);
+        return v;
+    }
+    static V2B_INLINE void store(uint8_t *p, V v)
+    {
+        memcpy(p, &v.lo, 8);
+        memcpy(p + 8, &v.hi, 8);
+    }
+    static V2B_INLINE V xor_(V a, V b) { return V{ a.lo ^ b.lo, a.hi ^ b.hi }; }
+
+    static V2B_INLINE uint32_t col(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3)
+    {
+        return kAes.t[0][c0 & 0xff] ^ kAes.t[1][(c1 >> 8) & 0xff] ^
+               kAes.t[2][(c2 >> 16) & 0xff] ^ kAes.t[3][c3 >> 24];
+    }
+    static V2B_INLINE V aesenc(V s, V k)
+    {
+        const uint32_t c0 = (uint32_t)s.lo, c1 = (uint32_t)(s.lo >> 32);
+        const uint32_t c2 = (uint32_t)s.hi, c3 = (uint32_t)(s.hi >> 32);
+
+        return V{ ((uint64_t)col(c1, c2, c3, c0) << 32 | col(c0, c1, c2, c3)) ^ k.lo,
+                  ((uint64_t)col(c3, c0, c1, c2) << 32 | col(c2, c3, c0, c1)) ^ k.hi };
+    }
+
+    static V2B_INLINE V unpacklo32(V a, V b)
+    {
+        return V{ (a.lo & 0xffffffff) | b.lo << 32, (a.lo >> 32) | (b.lo & 0xffffffff00000000ULL) };
+    }
+    static V2B_INLINE V unpackhi32(V a, V b)
+    {
+        return V{ (a.hi & 0xffffffff) | b.hi << 32, (a.hi >> 32) | (b.hi & 0xffffffff00000000ULL) };
+    }
+
+    /* lo (x) hi: tab[i] = lo * i (67 bits), hi consumed a nibble at a
+       time from the top */
+    static V2B_INLINE V clmul_lohi(V a)
+    {
+        uint64_t tlo[16], thi[16];
+        tlo[0] = thi[0] = 0;
+        tlo[1] = a.lo;
+        thi[1] = 0;
+        for (int i = 2; i < 16; i += 2) {
+            tlo[i]     = tlo[i >> 1] << 1;
+            thi[i]     = thi[i >> 1] << 1 | tlo[i >> 1] >> 63;
+            tlo[i + 1] = tlo[i] ^ a.lo;
+            thi[i + 1] = thi[i];
+        }
+
+        uint64_t lo = 0, hi = 0;
+        for (int i = 60; i >= 0; i -= 4) {
+            const unsigned n = (a.hi >> i) & 15;
+            hi = (hi << 4 | lo >> 60) ^ thi[n];
+            lo = (lo << 4) ^ tlo[n];
+        }
+        return V{ lo, hi };
+    }
+
+    static V2B_INLINE uint64_t mulhrs64(uint64_t a, uint64_t b)
+    {
+        uint64_t r = 0;
+        for (int i = 0; i < 64; i += 16) {
+            const int32_t p = (int32_t)(int16_t)(a >> i) * (int16_t)(b >> i);
+            r |= (uint64_t)(uint16_t)((p + 0x4000) >> 15) << i;
+        }
+        return r;
+    }
+    static V2B_INLINE V mulhrs(V a, V b) { return V{ mulhrs64(a.lo, b.lo), mulhrs64(a.hi, b.hi) }; }
+
+    static V2B_INLINE uint64_t low64(V a) { return a.lo; }
+    static V2B_INLINE V from_u32(uint32_t x) { return V{ x, 0 }; }
+};
+
+typedef verus2b::Stages<Port> PortStages;
+
+} /* namespace */
+
+/*---------------- key state ----------------------------------------*/
+/* key: the working key clhash mutates; refresh: its first
+   VERUS_V2B_REFRESH_SIZE bytes as generated.  Only the 64 words listed
+   in moved[] differ between the two after a hash, so a repeated seed
+   restores those instead of copying 8 KiB (upstream fixupkey).  One per
+   thread for verus_hash_v2b(), or owned by the caller. */
+struct verus_v2b_ctx {
+    alignas(32) uint8_t key[VERUS_V2B_KEY_SIZE];
+    alignas(32) uint8_t refresh[VERUS_V2B_REFRESH_SIZE];
+    uint8_t  seed[32];
+    uint16_t moved[64];
+    bool     valid;
+};
+
+static thread_local verus_v2b_ctx tls_key;
+
+extern "C" const verus_v2b_engine verus_v2b_port = {
+    "portable",
+    PortStages::sponge,
+    PortStages::keygen,
+    PortStages::clhash,
+    PortStages::keyed,
+};
+
+const verus_v2b_engine *verus_v2b_engine_get(void)
+{
+#if HARAKA_DISPATCH
+    if (IsCPUVerusOptimized())
+        return &verus_v2b_aesni;
+#endif
+    return &verus_v2b_port;
+}
+
+/* plain C allocation: the library does not link the C++ runtime */
+verus_v2b_ctx *verus_v2b_ctx_new(void)
+{
+    verus_v2b_ctx *ctx = (verus_v2b_ctx *)aligned_alloc(alignof(verus_v2b_ctx), sizeof(verus_v2b_ctx));
+    if (ctx)
+        ctx->valid = false;
+    return ctx;
+}
+
+void verus_v2b_ctx_free(verus_v2b_ctx *ctx)
+{
+    free(ctx);
+}
+
+void verus_hash_v2b(unsigned char *out, const unsigned char *in, size_t len)
+{
+    verus_hash_v2b_ctx(&tls_key, out, in, len);
+}
+
+void verus_hash_v2b_ctx(verus_v2b_ctx *ctx, unsigned char *out,
+                        const unsigned char *in, size_t len)
+{
+    const verus_v2b_engine *e = verus_v2b_engine_get();
+    verus_v2b_ctx &ks = *ctx;
+    alignas(16) uint8_t block[64];
+
+    const size_t pos = e->sponge(block, in, len);
+
+    if (ks.valid && memcmp(ks.seed, block, 32) == 0) {
+        for (int i = 0; i < 64; ++i)
+            memcpy(ks.key + 16 * ks.moved[i], ks.refresh + 16 * ks.moved[i], 16);
+    } else {
+        e->keygen(ks.key, block);
+        memcpy(ks.refresh, ks.key, VERUS_V2B_REFRESH_SIZE);
+        memcpy(ks.seed, block, 32);
+        ks.valid = true;
+    }
+
+    const uint64_t im = e->clhash(ks.key, block, ks.moved);
+    e->keyed(out, block, pos, ks.key, im);
+}
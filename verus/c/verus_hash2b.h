@@ -0,0 +1,78 @@
+#ifndef VERUS_HASH2B_H
+#define VERUS_HASH2B_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Full VerusHash 2.2 as the Verus chain mines and verifies it: the
+// sponge of CVerusHashV2(SOLUTION_VERUSHHASH_V2_2)::Write, then
+// Finalize2b (GenNewCLKey key chain, verusclhash_sv2_2 key mutation and
+// the dynamically keyed Haraka-512) of origin-impl/verus_hash.h, bit for
+// bit.  This is upstream Haraka (real AES S-box, standard round
+// constants), unlike verus_hash() / verus_hash_v2_2() above, which
+// follow the VRSC constants and truncated S-box of the Solana program.
+//
+// Host builds only (verus_hash2b.cpp): the key and its refresh copy live
+// in thread-local storage or a verus_v2b_ctx (below), and are reused
+// while consecutive hashes share the 32-byte seed (the chain value
+// before the last block), as upstream does.  AES-NI + PCLMULQDQ when
+// the CPU has them and the Haraka dispatch is not pinned to the
+// portable level, else portable.
+//
+// A message shorter than 32 bytes has the all-zero seed.  A fresh key
+// state has no key yet, so its first hash derives the key even for
+// that seed, here and in origin-impl alike.
+#define VERUS_V2B_KEY_SIZE     8832   // VERUSKEYSIZE, 8192 + 40 * 16
+#define VERUS_V2B_REFRESH_SIZE 8192   // keyMask + 1: the part that mutates
+
+// Writes the 32-byte hash of in[0..len) to out.
+void verus_hash_v2b(unsigned char *out, const unsigned char *in, size_t len);
+
+// Key state of one worker (key, refresh copy, seed, moved words), for
+// callers that would rather own it than use the thread-local one: make
+// one per worker up front and pass it to every hash that worker does.
+// A context must not be used by two threads at once.  new() returns
+// NULL if it cannot allocate.
+typedef struct verus_v2b_ctx verus_v2b_ctx;
+
+verus_v2b_ctx *verus_v2b_ctx_new(void);
+void verus_v2b_ctx_free(verus_v2b_ctx *ctx);
+
+// verus_hash_v2b() with the key state of ctx.
+void verus_hash_v2b_ctx(verus_v2b_ctx *ctx, unsigned char *out,
+                        const unsigned char *in, size_t len);
+
+// The stages of one engine, for tests and bench_verushash2b.cpp.
+// verus_hash_v2b() is, with key caching left out:
+//   pos = sponge(block, in, len);
+//   keygen(key, block);                       // seed = block[0..32)
+//   im  = clhash(key, block, moved);          // mutates key
+//   keyed(out, block, pos, key, im);
+typedef struct verus_v2b_engine {
+    const char *name;
+    size_t   (*sponge)(uint8_t block[64], const uint8_t *in, size_t len);
+    void     (*keygen)(uint8_t *key, const uint8_t seed[32]);
+    uint64_t (*clhash)(uint8_t *key, const uint8_t block[64], uint16_t moved[64]);
+    void     (*keyed)(uint8_t out[32], uint8_t block[64], size_t pos,
+                      const uint8_t *key, uint64_t intermediate);
+} verus_v2b_engine;
+
+// Portable C++ engine; runs anywhere.
+extern const verus_v2b_engine verus_v2b_port;
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(__bpf__) && !defined(__BPF__)
+// AES-NI + PCLMULQDQ + SSSE3 (verus_hash2b_aesni.cpp); the caller must
+// check the CPU.
+extern const verus_v2b_engine verus_v2b_aesni;
+#endif
+
+// Engine verus_hash_v2b() uses on this CPU.
+const verus_v2b_engine *verus_v2b_engine_get(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* VERUS_HASH2B_H */
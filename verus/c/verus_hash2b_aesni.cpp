@@ -0,0 +1,53 @@
+/*--------------------------------------------------------------------
+ * verus_hash2b_aesni.cpp  –  full VerusHash 2.2 stages with AES-NI,
+ *                            PCLMULQDQ and SSSE3
+ *
+ *   Built with -maes -mpclmul -mssse3 on x86 hosts only (see
+ *   build.sh) and reached through verus_v2b_engine_get() once
+ *   IsCPUVerusOptimized() reports the three extensions.  Same stages
+ *   as the portable engine (verus_hash2b_tmpl.h), one instruction per
+ *   backend primitive, as upstream verus_clhash.cpp / haraka.c.
+ *------------------------------------------------------------------*/
+#include "verus_hash2b_tmpl.h"
+
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+
+namespace {
+
+struct Ni {
+    typedef __m128i V;
+
+    static V2B_INLINE V load(const uint8_t *p) { return _mm_loadu_si128((const __m128i *)p); }
+    static V2B_INLINE void store(uint8_t *p, V v) { _mm_storeu_si128((__m128i *)p, v); }
+    static V2B_INLINE V xor_(V a, V b) { return _mm_xor_si128(a, b); }
+    static V2B_INLINE V aesenc(V s, V k) { return _mm_aesenc_si128(s, k); }
+    static V2B_INLINE V unpacklo32(V a, V b) { return _mm_unpacklo_epi32(a, b); }
+    static V2B_INLINE V unpackhi32(V a, V b) { return _mm_unpackhi_epi32(a, b); }
+    static V2B_INLINE V clmul_lohi(V a) { return _mm_clmulepi64_si128(a, a, 0x10); }
+    static V2B_INLINE V mulhrs(V a, V b) { return _mm_mulhrs_epi16(a, b); }
+    static V2B_INLINE uint64_t low64(V a)
+    {
+#if defined(__x86_64__)
+        return (uint64_t)_mm_cvtsi128_si64(a);
+#else
+        uint64_t lo;
+        _mm_storel_epi64((__m128i *)&lo, a);
+        return lo;
+#endif
+    }
+    static V2B_INLINE V from_u32(uint32_t x) { return _mm_cvtsi32_si128((int)x); }
+};
+
+typedef verus2b::Stages<Ni> NiStages;
+
+} /* namespace */
+
+extern "C" const verus_v2b_engine verus_v2b_aesni = {
+    "AES-NI",
+    NiStages::sponge,
+    NiStages::keygen,
+    NiStages::clhash,
+    NiStages::keyed,
+};
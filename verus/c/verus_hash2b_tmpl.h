@@ -0,0 +1,372 @@
+/*───────────────────────────────────────────────────────────*
+ *  verus_hash2b_tmpl.h  –  full VerusHash 2.2 (Finalize2b)  *
+ *                          stages, generic over a 128-bit   *
+ *                          vector backend (C++ only, host)  *
+ *                                                           *
+ *  One body for every engine, so the portable and AES-NI    *
+ *  builds cannot drift apart.  The backend B provides:      *
+ *                                                           *
+ *    typedef ... V;                 128-bit value            *
+ *    V    load(const uint8_t *p);   16 bytes, any alignment  *
+ *    void store(uint8_t *p, V v);                            *
+ *    V    xor_(V a, V b);                                    *
+ *    V    aesenc(V s, V k);         one real AES round       *
+ *    V    unpacklo32(V a, V b);     _mm_unpacklo_epi32       *
+ *    V    unpackhi32(V a, V b);     _mm_unpackhi_epi32       *
+ *    V    clmul_lohi(V a);          _mm_clmulepi64(a,a,0x10) *
+ *    V    mulhrs(V a, V b);         _mm_mulhrs_epi16         *
+ *    uint64_t low64(V a);                                    *
+ *    V    from_u32(uint32_t x);     _mm_cvtsi32_si128        *
+ *                                                           *
+ *  Unlike the rest of verus/c this is upstream Haraka: the  *
+ *  real AES S-box and the standard round constants.         *
+ *───────────────────────────────────────────────────────────*/
+#ifndef VERUS_HASH2B_TMPL_H
+#define VERUS_HASH2B_TMPL_H
+
+#ifndef __cplusplus
+#error "verus_hash2b_tmpl.h requires C++"
+#endif
+
+#include "verus_hash2b.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define V2B_INLINE inline __attribute__((always_inline))
+
+namespace verus2b {
+
+/* standard Haraka v2 round constants (upstream load_constants) */
+static constexpr uint8_t kRC[40][16] =
+#include "haraka_rc_std.inc"
+;
+
+/* CLHASH key in 16-byte words: keyMask >> 4 selects the mutable part,
+   the reads of AES / monkins cases may run up to 40 words past it */
+static constexpr unsigned kMaskWords = VERUS_V2B_REFRESH_SIZE / 16 - 1;   /* 511 */
+
+template <class B>
+struct Stages {
+    typedef typename B::V V;
+
+    /*──────────────── Haraka (upstream AES2 / MIX2 / AES4 / MIX4) ─*/
+    static V2B_INLINE void aes2(V &s0, V &s1, const uint8_t *rc)
+    {
+        s0 = B::aesenc(s0, B::load(rc));
+        s1 = B::aesenc(s1, B::load(rc + 16));
+        s0 = B::aesenc(s0, B::load(rc + 32));
+        s1 = B::aesenc(s1, B::load(rc + 48));
+    }
+
+    static V2B_INLINE void mix2(V &s0, V &s1)
+    {
+        const V t = B::unpacklo32(s0, s1);
+        s1 = B::unpackhi32(s0, s1);
+        s0 = t;
+    }
+
+    /* Haraka-512 with 40 round keys at rc, truncated to 32 bytes */
+    static V2B_INLINE void haraka512_rc(uint8_t out[32], const uint8_t in[64], const uint8_t *rc)
+    {
+        V s[4], t;
+
+        for (int i = 0; i < 4; ++i)
+            s[i] = B::load(in + 16 * i);
+        for (int r = 0; r < 5; ++r) {
+            const uint8_t *k = rc + 128 * r;
+            for (int j = 0; j < 2; ++j, k += 64)
+                for (int i = 0; i < 4; ++i)
+                    s[i] = B::aesenc(s[i], B::load(k + 16 * i));
+            t    = B::unpacklo32(s[0], s[1]);
+            s[0] = B::unpackhi32(s[0], s[1]);
+            s[1] = B::unpacklo32(s[2], s[3]);
+            s[2] = B::unpackhi32(s[2], s[3]);
+            s[3] = B::unpacklo32(s[0], s[2]);
+            s[0] = B::unpackhi32(s[0], s[2]);
+            s[2] = B::unpackhi32(s[1], t);
+            s[1] = B::unpacklo32(s[1], t);
+        }
+
+        uint8_t full[64];
+        for (int i = 0; i < 4; ++i)
+            B::store(full + 16 * i, B::xor_(s[i], B::load(in + 16 * i)));
+        memcpy(out,      full + 8,  8);
+        memcpy(out + 8,  full + 24, 8);
+        memcpy(out + 16, full + 32, 8);
+        memcpy(out + 24, full + 48, 8);
+    }
+
+    static void haraka512(uint8_t out[32], const uint8_t in[64])
+    {
+        haraka512_rc(out, in, &kRC[0][0]);
+    }
+
+    static void haraka512_keyed(uint8_t out[32], const uint8_t in[64], const uint8_t *rc)
+    {
+        haraka512_rc(out, in, rc);
+    }
+
+    static V2B_INLINE void haraka256(uint8_t out[32], const uint8_t in[32])
+    {
+        const V i0 = B::load(in), i1 = B::load(in + 16);
+        V s0 = i0, s1 = i1;
+
+        for (int r = 0; r < 5; ++r) {
+            aes2(s0, s1, kRC[4 * r]);
+            mix2(s0, s1);
+        }
+        B::store(out,      B::xor_(s0, i0));
+        B::store(out + 16, B::xor_(s1, i1));
+    }
+
+    /*──────────────── stages ───────────────────────────────────────*/
+    /* CVerusHashV2::Write + the first FillExtra of Finalize2b: block
+       = chain || tail, the tail padded with repeats of the chain's
+       first bytes.  Returns the tail length (curPos). */
+    static size_t sponge(uint8_t block[64], const uint8_t *in, size_t len)
+    {
+        memset(block, 0, 32);
+        for (; len >= 32; in += 32, len -= 32) {
+            memcpy(block + 32, in, 32);
+            haraka512(block, block);
+        }
+        memcpy(block + 32, in, len);
+        for (size_t pos = len; pos < 32; pos += 16)
+            memcpy(block + 32 + pos, block, 32 - pos < 16 ? 32 - pos : 16);
+        return len;
+    }
+
+    /* GenNewCLKey: Haraka-256 chained from the seed over the key */
+    static void keygen(uint8_t *key, const uint8_t seed[32])
+    {
+        haraka256(key, seed);
+        for (unsigned i = 32; i < VERUS_V2B_KEY_SIZE; i += 32)
+            haraka256(key + i, key + i - 32);
+    }
+
+    /* verusclhash_sv2_2: 32 key-dependent rounds over the block that
+       mutate the key in place; the two words each round touches are
+       appended to moved[64] (the upstream pMoveScratch), then the
+       lazy length hash and the 64-bit reduction. */
+    static uint64_t clhash(uint8_t *key, const uint8_t block[64], uint16_t *moved)
+    {
+        const V b2 = B::load(block + 32), b3 = B::load(block + 48);
+        const V pbuf_copy[4] = { B::xor_(B::load(block), b2),
+                                 B::xor_(B::load(block + 16), b3), b2, b3 };
+        V acc = B::load(key + 16 * (kMaskWords + 2));
+
+        for (int i = 0; i < 32; ++i) {
+            const uint64_t selector = B::low64(acc);
+            uint8_t *prand   = key + 16 * ((selector >> 5) & kMaskWords);
+            uint8_t *prandex = key + 16 * ((selector >> 32) & kMaskWords);
+
+            *moved++ = (uint16_t)((selector >> 5) & kMaskWords);
+            *moved++ = (uint16_t)((selector >> 32) & kMaskWords);
+
+            /* pbuf and the buffer next to it, in selector-chosen order */
+            const V *pbuf  = pbuf_copy + (selector & 3);
+            const V *pbuf2 = (selector & 1) ? pbuf - 1 : pbuf + 1;
+
+            switch (selector & 0x1c) {
+            case 0: {
+                const V temp1 = B::load(prandex);
+                const V add1 = B::xor_(temp1, *pbuf2);
+                acc = B::xor_(B::clmul_lohi(add1), acc);
+
+                const V tempa2 = B::xor_(B::mulhrs(acc, temp1), temp1);
+
+                const V temp12 = B::load(prand);
+                B::store(prand, tempa2);
+
+                const V add12 = B::xor_(temp12, *pbuf);
+                acc = B::xor_(B::clmul_lohi(add12), acc);
+
+                B::store(prandex, B::xor_(B::mulhrs(acc, temp12), temp12));
+                break;
+            }
+            case 4: {
+                const V temp1 = B::load(prand);
+                const V temp2 = *pbuf;
+                acc = B::xor_(B::clmul_lohi(B::xor_(temp1, temp2)), acc);
+                acc = B::xor_(B::clmul_lohi(temp2), acc);
+
+                const V tempa2 = B::xor_(B::mulhrs(acc, temp1), temp1);
+
+                const V temp12 = B::load(prandex);
+                B::store(prandex, tempa2);
+
+                acc = B::xor_(B::xor_(temp12, *pbuf2), acc);
+
+                B::store(prand, B::xor_(B::mulhrs(acc, temp12), temp12));
+                break;
+            }
+            case 8: {
+                const V temp1 = B::load(prandex);
+                acc = B::xor_(B::xor_(temp1, *pbuf), acc);
+
+                const V tempa2 = B::xor_(B::mulhrs(acc, temp1), temp1);
+
+                const V temp12 = B::load(prand);
+                B::store(prand, tempa2);
+
+                const V temp22 = *pbuf2;
+                acc = B::xor_(B::clmul_lohi(B::xor_(temp12, temp22)), acc);
+                acc = B::xor_(B::clmul_lohi(temp22), acc);
+
+                B::store(prandex, B::xor_(B::mulhrs(acc, temp12), temp12));
+                break;
+            }
+            case 0xc: {
+                const V temp1 = B::load(prand);
+                acc = B::xor_(B::xor_(temp1, *pbuf2), acc);
+
+                /* non-zero and never -1: bits 2..4 of selector are 011 */
+                const int32_t divisor = (int32_t)(uint32_t)selector;
+                const int64_t dividend = (int64_t)B::low64(acc);
+                acc = B::xor_(B::from_u32((uint32_t)(dividend % divisor)), acc);
+
+                const V tempa2 = B::xor_(B::mulhrs(acc, temp1), temp1);
+
+                if (dividend & 1) {
+                    const V temp12 = B::load(prandex);
+                    B::store(prandex, tempa2);
+
+                    const V temp22 = *pbuf;
+                    acc = B::xor_(B::clmul_lohi(B::xor_(temp12, temp22)), acc);
+                    acc = B::xor_(B::clmul_lohi(temp22), acc);
+
+                    B::store(prand, B::xor_(B::mulhrs(acc, temp12), temp12));
+                } else {
+                    const V tempb3 = B::load(prandex);
+                    B::store(prandex, tempa2);
+                    B::store(prand, tempb3);
+                    acc = B::xor_(*pbuf, acc);
+                }
+                break;
+            }
+            case 0x10: {
+                /* a few AES rounds keyed by the key itself */
+                V temp1 = *pbuf2, temp2 = *pbuf;
+
+                aes2(temp1, temp2, prand);
+                mix2(temp1, temp2);
+                aes2(temp1, temp2, prand + 64);
+                mix2(temp1, temp2);
+                aes2(temp1, temp2, prand + 128);
+                mix2(temp1, temp2);
+                acc = B::xor_(temp2, B::xor_(temp1, acc));
+
+                const V tempa1 = B::load(prand);
+                const V tempa3 = B::xor_(tempa1, B::mulhrs(acc, tempa1));
+
+                const V tempa4 = B::load(prandex);
+                B::store(prandex, tempa3);
+                B::store(prand, tempa4);
+                break;
+            }
+            case 0x14: {
+                /* the "monkins loop": 1..8 rounds of clmul or AES */
+                uint64_t rounds = selector >> 61;
+                const uint8_t *rc = prand;
+                unsigned aesroundoffset = 0;
+
+                do {
+                    V onekey = B::load(rc);
+                    rc += 16;
+                    if (selector & ((uint64_t)0x10000000 << rounds)) {
+                        const V temp2 = rounds & 1 ? *pbuf : *pbuf2;
+                        acc = B::xor_(B::clmul_lohi(B::xor_(onekey, temp2)), acc);
+                    } else {
+                        V temp2 = rounds & 1 ? *pbuf2 : *pbuf;
+                        aes2(onekey, temp2, rc + 16 * aesroundoffset);
+                        aesroundoffset += 4;
+                        mix2(onekey, temp2);
+                        acc = B::xor_(temp2, B::xor_(onekey, acc));
+                    }
+                } while (rounds--);
+
+                const V tempa1 = B::load(prand);
+                const V tempa3 = B::xor_(tempa1, B::mulhrs(acc, tempa1));
+
+                const V tempa4 = B::load(prandex);
+                B::store(prandex, tempa3);
+                B::store(prand, tempa4);
+                break;
+            }
+            case 0x18: {
+                uint64_t rounds = selector >> 61;
+                const uint8_t *rc = prand;
+                V onekey;
+
+                do {
+                    onekey = B::load(rc);
+                    rc += 16;
+                    if (selector & ((uint64_t)0x10000000 << rounds)) {
+                        onekey = B::xor_(onekey, rounds & 1 ? *pbuf : *pbuf2);
+                        /* non-zero and never -1: bits 2..4 are 110 */
+                        const int32_t divisor = (int32_t)(uint32_t)selector;
+                        const int64_t dividend = (int64_t)B::low64(onekey);
+                        acc = B::xor_(B::from_u32((uint32_t)(dividend % divisor)), acc);
+                    } else {
+                        onekey = B::clmul_lohi(B::xor_(onekey, rounds & 1 ? *pbuf2 : *pbuf));
+                        acc = B::xor_(B::mulhrs(acc, onekey), acc);
+                    }
+                } while (rounds--);
+
+                const V tempa4 = B::xor_(B::load(prandex), acc);
+                B::store(prandex, onekey);
+                B::store(prand, tempa4);
+                break;
+            }
+            case 0x1c: {
+                const V temp2 = B::load(prandex);
+                acc = B::xor_(B::clmul_lohi(B::xor_(*pbuf, temp2)), acc);
+
+                const V tempa2 = B::xor_(B::mulhrs(acc, temp2), temp2);
+
+                const V tempa3 = B::load(prand);
+                B::store(prand, tempa2);
+
+                acc = B::xor_(tempa3, acc);
+                acc = B::xor_(*pbuf2, acc);
+                B::store(prandex, B::xor_(B::mulhrs(acc, tempa3), tempa3));
+                break;
+            }
+            }
+        }
+
+        /* lazyLengthHash(1024, 64) = 64 (x) 1024 = x^16, only in the low
+           half; precompReduction64 needs no more than the low 64 bits of
+           acc and the high 64 bits of acc, reduced by x^64 = x^4+x^3+x+1
+           (the high word of A.hi * 0x1b has at most 4 bits). */
+        uint8_t a[16];
+        uint64_t lo, hi;
+        B::store(a, acc);
+        memcpy(&lo, a, 8);
+        memcpy(&hi, a + 8, 8);
+        lo ^= 0x10000;
+
+        static const uint8_t kReduce[16] = { 0, 27, 54, 45, 108, 119, 90, 65,
+                                             216, 195, 238, 245, 180, 175, 130, 153 };
+        const uint64_t q2lo = hi ^ (hi << 1) ^ (hi << 3) ^ (hi << 4);
+        const uint64_t q2hi = (hi >> 63) ^ (hi >> 61) ^ (hi >> 60);
+        return lo ^ q2lo ^ kReduce[q2hi];
+    }
+
+    /* the rest of Finalize2b: fill the tail with the intermediate, then
+       Haraka-512 keyed by the mutated key at its offset */
+    static void keyed(uint8_t out[32], uint8_t block[64], size_t pos,
+                      const uint8_t *key, uint64_t intermediate)
+    {
+        uint8_t im[8];
+        memcpy(im, &intermediate, 8);
+        for (; pos < 32; pos += 8)
+            memcpy(block + 32 + pos, im, 32 - pos < 8 ? 32 - pos : 8);
+        haraka512_keyed(out, block, key + 16 * (intermediate & kMaskWords));
+    }
+};
+
+} /* namespace verus2b */
+
+#endif /* VERUS_HASH2B_TMPL_H */
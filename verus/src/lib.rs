@@ -4,6 +4,11 @@
 // BPF environment is no_std. Host environment (including tests) uses std.
 #![cfg_attr(target_arch = "bpf", no_std)]
 
+extern crate alloc;
+
+use alloc::vec::Vec;
+use core::ops::Range;
+
 // This module provides the VerusHash implementation.
 // It's compiled only when targeting BPF or when the 'portable' feature is enabled.
 #[cfg(any(target_arch = "bpf", feature = "portable"))]
@@ -25,8 +30,47 @@ mod backend {
         // Name in C is `verus_hash`.
         fn verus_hash(out_ptr: *mut u8, in_ptr: *const u8, len: usize);
 
+        // Strided batches: `count` messages of `len` bytes, `stride` apart.
+        fn verus_hash_v2_2_batch(out: *mut u8, inp: *const u8, stride: usize, len: usize, count: usize);
+        fn verus_hash_batch(out: *mut u8, inp: *const u8, stride: usize, len: usize, count: usize);
+
+        // Nonce search (see verus_hash.h): 1 hit, 0 none, -1 bad arguments.
+        fn verus_search_v2_2(
+            tmpl: *const u8,
+            len: usize,
+            nonce_offset: usize,
+            start: u64,
+            count: u64,
+            target: *const u8,
+            found: *mut u64,
+        ) -> i32;
+
+        // Streaming API (see verus_hash.h); ctx is a `verus_hash_ctx`.
+        fn verus_v1_init(ctx: *mut super::HasherCtx);
+        fn verus_v1_update(ctx: *mut super::HasherCtx, data: *const u8, len: usize);
+        fn verus_v1_final(ctx: *const super::HasherCtx, out: *mut u8);
+        fn verus_v2_2_init(ctx: *mut super::HasherCtx);
+        fn verus_v2_2_update(ctx: *mut super::HasherCtx, data: *const u8, len: usize);
+        fn verus_v2_2_final(ctx: *const super::HasherCtx, out: *mut u8);
+
+        // Midstate API (see verus_hash.h); the state is VERUS_MIDSTATE_SIZE bytes.
+        fn verus_midstate_init(mid: *mut u8, version: i32, prefix: *const u8, len: usize) -> i32;
+        fn verus_midstate_absorb(mid: *mut u8, data: *const u8, len: usize) -> i32;
+        fn verus_midstate_finish(out: *mut u8, mid: *const u8, suffix: *const u8, len: usize) -> i32;
+        fn verus_midstate_check(mid: *const u8) -> i32;
+
+        // Full VerusHash 2.2 (see verus_hash2b.h); host builds only.
+        #[cfg(not(target_arch = "bpf"))]
+        fn verus_hash_v2b(out_ptr: *mut u8, in_ptr: *const u8, len: usize);
+        #[cfg(not(target_arch = "bpf"))]
+        fn verus_v2b_ctx_new() -> *mut core::ffi::c_void;
+        #[cfg(not(target_arch = "bpf"))]
+        fn verus_v2b_ctx_free(ctx: *mut core::ffi::c_void);
+        #[cfg(not(target_arch = "bpf"))]
+        fn verus_hash_v2b_ctx(ctx: *mut core::ffi::c_void, out_ptr: *mut u8, in_ptr: *const u8, len: usize);
+
         // Expose the static round constant array from the C code.
-        // Its actual name in haraka_portable.c is `rc`.
+        // Its actual name in haraka_portable.cpp is `rc`.
         static rc: [u8; 40 * 16]; // 640 bytes total
 
         // Initialization function (`verus_hash_v2_init`) is no longer needed.
@@ -56,6 +100,134 @@ mod backend {
         out
     }
 
+    /// Full VerusHash 2.2 (upstream `Finalize2b`) of `data`; raw bytes.
+    #[cfg(not(target_arch = "bpf"))]
+    pub fn verus_hash_v2b_impl(data: &[u8]) -> [u8; 32] {
+        let mut out = [0u8; 32];
+        unsafe { verus_hash_v2b(out.as_mut_ptr(), data.as_ptr(), data.len()) };
+        out
+    }
+
+    /// New `verus_v2b_ctx`; null if the C side cannot allocate it.
+    #[cfg(not(target_arch = "bpf"))]
+    pub fn v2b_ctx_new_impl() -> *mut core::ffi::c_void {
+        unsafe { verus_v2b_ctx_new() }
+    }
+
+    #[cfg(not(target_arch = "bpf"))]
+    pub fn v2b_ctx_free_impl(ctx: *mut core::ffi::c_void) {
+        unsafe { verus_v2b_ctx_free(ctx) }
+    }
+
+    /// [`verus_hash_v2b_impl`] with the key state of `ctx`.
+    #[cfg(not(target_arch = "bpf"))]
+    pub fn v2b_ctx_hash_impl(ctx: *mut core::ffi::c_void, data: &[u8]) -> [u8; 32] {
+        let mut out = [0u8; 32];
+        unsafe { verus_hash_v2b_ctx(ctx, out.as_mut_ptr(), data.as_ptr(), data.len()) };
+        out
+    }
+
+    /// VerusHash 2.0 of the first `out.len()` `stride`-byte messages of `data`.
+    pub fn hash_batch_v2_impl(data: &[u8], stride: usize, out: &mut [[u8; 32]]) {
+        debug_assert!(out.len() * stride <= data.len());
+        unsafe { verus_hash_v2_2_batch(out.as_mut_ptr().cast(), data.as_ptr(), stride, stride, out.len()) };
+    }
+
+    /// VerusHash 1.0 of the first `out.len()` `stride`-byte messages of `data`.
+    pub fn hash_batch_v1_impl(data: &[u8], stride: usize, out: &mut [[u8; 32]]) {
+        debug_assert!(out.len() * stride <= data.len());
+        unsafe { verus_hash_batch(out.as_mut_ptr().cast(), data.as_ptr(), stride, stride, out.len()) };
+    }
+
+    /// First nonce in `start..start + count` (wrapping) whose v2.2 hash of
+    /// `template` is <= `target_be`; the caller has checked the layout.
+    pub fn search_v2_impl(
+        template: &[u8],
+        nonce_offset: usize,
+        start: u64,
+        count: u64,
+        target_be: &[u8; 32],
+    ) -> Option<u64> {
+        let mut found = 0u64;
+        let status = unsafe {
+            verus_search_v2_2(
+                template.as_ptr(),
+                template.len(),
+                nonce_offset,
+                start,
+                count,
+                target_be.as_ptr(),
+                &mut found,
+            )
+        };
+        debug_assert!(status >= 0, "bad search template");
+        (status == 1).then_some(found)
+    }
+
+    /// Fresh streaming context for VerusHash 2.0 (`v2`) or 1.0.
+    pub fn hasher_init_impl(v2: bool) -> super::HasherCtx {
+        let mut ctx = super::HasherCtx::EMPTY;
+        unsafe {
+            if v2 {
+                verus_v2_2_init(&mut ctx)
+            } else {
+                verus_v1_init(&mut ctx)
+            }
+        };
+        ctx
+    }
+
+    /// Feeds `data` to a streaming context.
+    pub fn hasher_update_impl(ctx: &mut super::HasherCtx, v2: bool, data: &[u8]) {
+        unsafe {
+            if v2 {
+                verus_v2_2_update(ctx, data.as_ptr(), data.len())
+            } else {
+                verus_v1_update(ctx, data.as_ptr(), data.len())
+            }
+        }
+    }
+
+    /// Hash of everything fed so far; `ctx` is unchanged.
+    pub fn hasher_final_impl(ctx: &super::HasherCtx, v2: bool) -> [u8; 32] {
+        let mut out = [0u8; 32];
+        unsafe {
+            if v2 {
+                verus_v2_2_final(ctx, out.as_mut_ptr())
+            } else {
+                verus_v1_final(ctx, out.as_mut_ptr())
+            }
+        };
+        out
+    }
+
+    /// Starts a midstate for `version` (0x01 or 0x22) with `prefix` absorbed.
+    pub fn midstate_init_impl(
+        mid: &mut [u8; super::MIDSTATE_LEN],
+        version: u8,
+        prefix: &[u8],
+    ) -> bool {
+        unsafe { verus_midstate_init(mid.as_mut_ptr(), version as i32, prefix.as_ptr(), prefix.len()) == 0 }
+    }
+
+    /// Absorbs `data` (a multiple of 32 bytes) into a midstate.
+    pub fn midstate_absorb_impl(mid: &mut [u8; super::MIDSTATE_LEN], data: &[u8]) -> bool {
+        unsafe { verus_midstate_absorb(mid.as_mut_ptr(), data.as_ptr(), data.len()) == 0 }
+    }
+
+    /// Finishes a well-formed midstate with `suffix`.
+    pub fn midstate_finish_impl(mid: &[u8; super::MIDSTATE_LEN], suffix: &[u8]) -> [u8; 32] {
+        let mut out = [0u8; 32];
+        let status = unsafe { verus_midstate_finish(out.as_mut_ptr(), mid.as_ptr(), suffix.as_ptr(), suffix.len()) };
+        debug_assert_eq!(status, 0, "malformed midstate");
+        out
+    }
+
+    /// Whether `mid` is a well-formed serialized midstate.
+    pub fn midstate_check_impl(mid: &[u8; super::MIDSTATE_LEN]) -> bool {
+        unsafe { verus_midstate_check(mid.as_ptr()) == 0 }
+    }
+
     /// Borrows the static Haraka round constant table (read-only).
     /// The symbol name in C is `rc`.
     pub fn haraka_rc() -> &'static [u8; 640] {
@@ -81,6 +253,82 @@ mod backend {
             "The `verus` crate must be built for the BPF target or with the `portable` feature enabled."
         );
     }
+    pub fn verus_hash_v2b_impl(_data: &[u8]) -> [u8; 32] {
+        compile_error!(
+            "The `verus` crate must be built for the BPF target or with the `portable` feature enabled."
+        );
+    }
+    pub fn v2b_ctx_new_impl() -> *mut core::ffi::c_void {
+        compile_error!(
+            "The `verus` crate must be built for the BPF target or with the `portable` feature enabled."
+        );
+    }
+    pub fn v2b_ctx_free_impl(_ctx: *mut core::ffi::c_void) {
+        compile_error!(
+            "The `verus` crate must be built for the BPF target or with the `portable` feature enabled."
+        );
+    }
+    pub fn v2b_ctx_hash_impl(_ctx: *mut core::ffi::c_void, _data: &[u8]) -> [u8; 32] {
+        compile_error!(
+            "The `verus` crate must be built for the BPF target or with the `portable` feature enabled."
+        );
+    }
+    pub fn hash_batch_v2_impl(_data: &[u8], _stride: usize, _out: &mut [[u8; 32]]) {
+        compile_error!(
+            "The `verus` crate must be built for the BPF target or with the `portable` feature enabled."
+        );
+    }
+    pub fn hash_batch_v1_impl(_data: &[u8], _stride: usize, _out: &mut [[u8; 32]]) {
+        compile_error!(
+            "The `verus` crate must be built for the BPF target or with the `portable` feature enabled."
+        );
+    }
+    pub fn search_v2_impl(
+        _template: &[u8],
+        _nonce_offset: usize,
+        _start: u64,
+        _count: u64,
+        _target_be: &[u8; 32],
+    ) -> Option<u64> {
+        compile_error!(
+            "The `verus` crate must be built for the BPF target or with the `portable` feature enabled."
+        );
+    }
+    pub fn hasher_init_impl(_v2: bool) -> super::HasherCtx {
+        compile_error!(
+            "The `verus` crate must be built for the BPF target or with the `portable` feature enabled."
+        );
+    }
+    pub fn hasher_update_impl(_ctx: &mut super::HasherCtx, _v2: bool, _data: &[u8]) {
+        compile_error!(
+            "The `verus` crate must be built for the BPF target or with the `portable` feature enabled."
+        );
+    }
+    pub fn hasher_final_impl(_ctx: &super::HasherCtx, _v2: bool) -> [u8; 32] {
+        compile_error!(
+            "The `verus` crate must be built for the BPF target or with the `portable` feature enabled."
+        );
+    }
+    pub fn midstate_init_impl(_mid: &mut [u8; super::MIDSTATE_LEN], _version: u8, _prefix: &[u8]) -> bool {
+        compile_error!(
+            "The `verus` crate must be built for the BPF target or with the `portable` feature enabled."
+        );
+    }
+    pub fn midstate_absorb_impl(_mid: &mut [u8; super::MIDSTATE_LEN], _data: &[u8]) -> bool {
+        compile_error!(
+            "The `verus` crate must be built for the BPF target or with the `portable` feature enabled."
+        );
+    }
+    pub fn midstate_finish_impl(_mid: &[u8; super::MIDSTATE_LEN], _suffix: &[u8]) -> [u8; 32] {
+        compile_error!(
+            "The `verus` crate must be built for the BPF target or with the `portable` feature enabled."
+        );
+    }
+    pub fn midstate_check_impl(_mid: &[u8; super::MIDSTATE_LEN]) -> bool {
+        compile_error!(
+            "The `verus` crate must be built for the BPF target or with the `portable` feature enabled."
+        );
+    }
     // haraka_rc is fine as it's a static, but for consistency:
     pub fn haraka_rc() -> &'static [u8; 640] {
         compile_error!(
@@ -96,6 +344,262 @@ mod backend {
 pub use backend::haraka_rc;
 pub use backend::verus_hash_v1_impl as verus_hash_v1; // Export V1 hash function
 pub use backend::verus_hash_v2_impl as verus_hash_v2; // Export V2 hash function
+#[cfg(not(target_arch = "bpf"))]
+pub use backend::verus_hash_v2b_impl as verus_hash_v2b; // Full VerusHash 2.2, host only
+
+/// Key state for [`verus_hash_v2b`] owned by one worker instead of its
+/// thread: create one per worker up front and hash through
+/// [`hash`](Self::hash), with the same results. Host only.
+#[cfg(not(target_arch = "bpf"))]
+pub struct VerusHashContext(core::ptr::NonNull<core::ffi::c_void>);
+
+// Safety: the C state is plain memory with no tie to the creating thread,
+// and `hash` takes `&mut self`, so one thread uses it at a time.
+#[cfg(not(target_arch = "bpf"))]
+unsafe impl Send for VerusHashContext {}
+
+#[cfg(not(target_arch = "bpf"))]
+impl VerusHashContext {
+    /// `None` if the state (about 17 KiB) cannot be allocated.
+    pub fn new() -> Option<Self> {
+        core::ptr::NonNull::new(backend::v2b_ctx_new_impl()).map(Self)
+    }
+
+    /// [`verus_hash_v2b`] of `data`, reusing this context's key.
+    pub fn hash(&mut self, data: &[u8]) -> [u8; 32] {
+        backend::v2b_ctx_hash_impl(self.0.as_ptr(), data)
+    }
+}
+
+#[cfg(not(target_arch = "bpf"))]
+impl Drop for VerusHashContext {
+    fn drop(&mut self) {
+        backend::v2b_ctx_free_impl(self.0.as_ptr());
+    }
+}
+
+/// [`verus_hash_v2`] of every `stride`-byte message in `data`
+/// (`data.chunks_exact(stride)`; a shorter tail is ignored).
+///
+/// One FFI call for the whole batch, which the C side hashes several
+/// messages at a time through the Haraka batch kernels.
+///
+/// # Panics
+/// If `stride` is 0.
+pub fn hash_batch(data: &[u8], stride: usize) -> Vec<[u8; 32]> {
+    assert!(stride > 0, "stride must be non-zero");
+    let mut out = alloc::vec![[0u8; 32]; data.len() / stride];
+    backend::hash_batch_v2_impl(data, stride, &mut out);
+    out
+}
+
+/// [`hash_batch`] into a caller buffer: `out[i]` receives the hash of
+/// `data[i * stride..(i + 1) * stride]`.
+///
+/// # Panics
+/// If `stride` is 0 or `data` holds fewer than `out.len()` messages.
+pub fn hash_batch_into(data: &[u8], stride: usize, out: &mut [[u8; 32]]) {
+    assert!(stride > 0, "stride must be non-zero");
+    assert!(out.len() <= data.len() / stride, "data holds fewer than out.len() messages");
+    backend::hash_batch_v2_impl(data, stride, out);
+}
+
+/// [`hash_batch`] for [`verus_hash_v1`].
+pub fn hash_batch_v1(data: &[u8], stride: usize) -> Vec<[u8; 32]> {
+    assert!(stride > 0, "stride must be non-zero");
+    let mut out = alloc::vec![[0u8; 32]; data.len() / stride];
+    backend::hash_batch_v1_impl(data, stride, &mut out);
+    out
+}
+
+/// [`hash_batch_into`] for [`verus_hash_v1`].
+pub fn hash_batch_v1_into(data: &[u8], stride: usize, out: &mut [[u8; 32]]) {
+    assert!(stride > 0, "stride must be non-zero");
+    assert!(out.len() <= data.len() / stride, "data holds fewer than out.len() messages");
+    backend::hash_batch_v1_impl(data, stride, out);
+}
+
+/// Longest template [`search_v2`] accepts.
+pub const SEARCH_MAX_LEN: usize = 256;
+
+/// Nonces of a range whose [`verus_hash_v2`] meets a target; see [`search_v2`].
+#[derive(Clone, Debug)]
+pub struct NonceSearch<'a> {
+    template: &'a [u8],
+    nonce_offset: usize,
+    target_be: [u8; 32],
+    nonces: Range<u64>,
+}
+
+/// Searches `nonces` for messages that meet `target_be`: for each nonce the
+/// message is `template` with the nonce written little-endian over
+/// `template[nonce_offset..nonce_offset + 8]`, and it hits when its
+/// big-endian [`verus_hash_v2`] is <= `target_be`.
+///
+/// The iterator yields the hits in order. Each `next()` is one FFI call
+/// that scans on from the last hit in native code (shared prefix blocks
+/// absorbed once, four nonces per permutation, word-wise target compare)
+/// and returns at the next hit, so `search_v2(..).next()` is "first valid
+/// nonce". Large ranges can be split into chunks to report progress.
+///
+/// # Panics
+/// If the nonce does not fit in `template` or the template is longer
+/// than [`SEARCH_MAX_LEN`].
+pub fn search_v2<'a>(
+    template: &'a [u8],
+    nonce_offset: usize,
+    nonces: Range<u64>,
+    target_be: &[u8; 32],
+) -> NonceSearch<'a> {
+    assert!(template.len() <= SEARCH_MAX_LEN, "template longer than SEARCH_MAX_LEN");
+    assert!(
+        nonce_offset.checked_add(8).map_or(false, |end| end <= template.len()),
+        "nonce does not fit in the template"
+    );
+    NonceSearch { template, nonce_offset, target_be: *target_be, nonces }
+}
+
+impl Iterator for NonceSearch<'_> {
+    type Item = u64;
+
+    fn next(&mut self) -> Option<u64> {
+        let Range { start, end } = self.nonces;
+        if start >= end {
+            return None;
+        }
+        match backend::search_v2_impl(self.template, self.nonce_offset, start, end - start, &self.target_be) {
+            Some(nonce) => {
+                self.nonces.start = nonce + 1;
+                Some(nonce)
+            }
+            None => {
+                self.nonces.start = end;
+                None
+            }
+        }
+    }
+}
+
+impl core::iter::FusedIterator for NonceSearch<'_> {}
+
+/// Size of a serialized [`VerusMidstate`].
+pub const MIDSTATE_LEN: usize = 144;
+
+/// A VerusHash sponge with a fixed message prefix already absorbed.
+///
+/// Hashing many messages that share a prefix (e.g. `challenge || ...`
+/// with a varying nonce) only needs the prefix permutations once:
+/// `VerusMidstate::v2(prefix)?.finish(suffix)` equals
+/// `verus_hash_v2(prefix || suffix)`. Prefixes are absorbed in whole
+/// 32-byte blocks. The state is plain bytes and can be stored or sent
+/// with [`to_bytes`](Self::to_bytes) / [`from_bytes`](Self::from_bytes).
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub struct VerusMidstate([u8; MIDSTATE_LEN]);
+
+impl VerusMidstate {
+    const V1: u8 = 0x01;
+    const V2_2: u8 = 0x22;
+
+    fn new(version: u8, prefix: &[u8]) -> Option<Self> {
+        let mut mid = [0u8; MIDSTATE_LEN];
+        backend::midstate_init_impl(&mut mid, version, prefix).then_some(Self(mid))
+    }
+
+    /// Midstate for [`verus_hash_v1`]; `None` unless `prefix.len() % 32 == 0`.
+    pub fn v1(prefix: &[u8]) -> Option<Self> {
+        Self::new(Self::V1, prefix)
+    }
+
+    /// Midstate for [`verus_hash_v2`]; `None` unless `prefix.len() % 32 == 0`.
+    pub fn v2(prefix: &[u8]) -> Option<Self> {
+        Self::new(Self::V2_2, prefix)
+    }
+
+    /// Absorbs more of the prefix; returns `false` (and leaves the state
+    /// unchanged) unless `data.len() % 32 == 0`.
+    pub fn absorb(&mut self, data: &[u8]) -> bool {
+        backend::midstate_absorb_impl(&mut self.0, data)
+    }
+
+    /// Little-endian hash of `prefix || suffix`.
+    pub fn finish(&self, suffix: &[u8]) -> [u8; 32] {
+        backend::midstate_finish_impl(&self.0, suffix)
+    }
+
+    /// Serialized state.
+    pub fn to_bytes(&self) -> [u8; MIDSTATE_LEN] {
+        self.0
+    }
+
+    /// Restores a state from [`to_bytes`](Self::to_bytes); `None` if malformed.
+    pub fn from_bytes(bytes: &[u8; MIDSTATE_LEN]) -> Option<Self> {
+        backend::midstate_check_impl(bytes).then_some(Self(*bytes))
+    }
+}
+
+/// Mirror of the C `verus_hash_ctx`.
+#[repr(C)]
+#[derive(Clone, Copy, Debug)]
+struct HasherCtx {
+    mid: [u8; MIDSTATE_LEN],
+    buf: [u8; 32],
+    buffered: usize,
+}
+
+impl HasherCtx {
+    #[allow(dead_code)] // only the C backend builds contexts
+    const EMPTY: Self = Self { mid: [0; MIDSTATE_LEN], buf: [0; 32], buffered: 0 };
+}
+
+/// Incremental VerusHash: feed the message in pieces with
+/// [`update`](Self::update), then [`finalize`](Self::finalize) gives the
+/// same hash as [`verus_hash_v2`] / [`verus_hash_v1`] over the
+/// concatenation, without first copying it into one buffer.
+///
+/// Only whole 32-byte blocks are absorbed; at most 31 bytes are held
+/// between updates. On the host it is also an [`std::io::Write`] sink,
+/// so e.g. a file can be hashed with `std::io::copy`.
+#[derive(Clone, Debug)]
+pub struct VerusHasher {
+    ctx: HasherCtx,
+    v2: bool,
+}
+
+impl VerusHasher {
+    /// Hasher for [`verus_hash_v1`].
+    pub fn v1() -> Self {
+        Self { ctx: backend::hasher_init_impl(false), v2: false }
+    }
+
+    /// Hasher for [`verus_hash_v2`].
+    pub fn v2() -> Self {
+        Self { ctx: backend::hasher_init_impl(true), v2: true }
+    }
+
+    /// Appends `data` to the message.
+    pub fn update(&mut self, data: &[u8]) -> &mut Self {
+        backend::hasher_update_impl(&mut self.ctx, self.v2, data);
+        self
+    }
+
+    /// Little-endian hash of everything fed so far. The hasher is not
+    /// consumed; further updates extend the same message.
+    pub fn finalize(&self) -> [u8; 32] {
+        backend::hasher_final_impl(&self.ctx, self.v2)
+    }
+}
+
+#[cfg(not(target_arch = "bpf"))]
+impl std::io::Write for VerusHasher {
+    fn write(&mut self, buf: &[u8]) -> std::io::Result<usize> {
+        self.update(buf);
+        Ok(buf.len())
+    }
+
+    fn flush(&mut self) -> std::io::Result<()> {
+        Ok(())
+    }
+}
 
 // --- FFI Helper for Constant Generation (Host Only) ---
 // Removed: Constants are now generated during the build process by build.rs
@@ -218,6 +722,334 @@ mod tests {
         }
     }
 
+    // ─────────────────────────────────────────────────────────────────────────────
+    //  Haraka engine equivalence: every batch / SIMD engine in the C library
+    //  must reproduce the scalar portable functions byte for byte.
+    // ─────────────────────────────────────────────────────────────────────────────
+    type HarakaFn = unsafe extern "C" fn(*mut u8, *const u8);
+
+    extern "C" {
+        fn haraka512_port(out: *mut u8, inp: *const u8);
+        fn haraka512_port_zero(out: *mut u8, inp: *const u8);
+        fn haraka256_port(out: *mut u8, inp: *const u8);
+        fn haraka512_port_x4(out: *mut u8, inp: *const u8);
+        fn haraka512_port_zero_x4(out: *mut u8, inp: *const u8);
+        fn haraka256_port_x4(out: *mut u8, inp: *const u8);
+        fn haraka512_port_bs8(out: *mut u8, inp: *const u8);
+        fn haraka512_port_zero_bs8(out: *mut u8, inp: *const u8);
+        fn haraka256_port_bs8(out: *mut u8, inp: *const u8);
+        fn verus_hash_v1_batch(out: *mut u8, inp: *const *const u8, len: *const usize, n: usize);
+    }
+
+    #[cfg(any(target_arch = "x86_64", target_arch = "x86"))]
+    extern "C" {
+        fn haraka512_vperm(out: *mut u8, inp: *const u8);
+        fn haraka512_vperm_zero(out: *mut u8, inp: *const u8);
+        fn haraka256_vperm(out: *mut u8, inp: *const u8);
+        fn haraka512_vperm_x2(out: *mut u8, inp: *const u8);
+        fn haraka512_vperm_zero_x2(out: *mut u8, inp: *const u8);
+        fn haraka256_vperm_x2(out: *mut u8, inp: *const u8);
+        fn haraka512_gather_x8(out: *mut u8, inp: *const u8);
+        fn haraka512_gather_zero_x8(out: *mut u8, inp: *const u8);
+        fn haraka256_gather_x8(out: *mut u8, inp: *const u8);
+        fn clmul_mix_pclmul(a: u64, b: u64) -> u64;
+    }
+
+    /// The three scalar functions with their input sizes.
+    const HARAKA_SCALAR: [(HarakaFn, usize); 3] = [
+        (haraka512_port, 64),
+        (haraka512_port_zero, 64),
+        (haraka256_port, 32),
+    ];
+
+    /// Deterministic test input; every third round only uses byte values
+    /// below 24, the live range of the VRSC S-box.
+    fn haraka_input(round: u64, buf: &mut [u8]) {
+        let mut x = round.wrapping_mul(0x9E37_79B9_7F4A_7C15) | 1;
+        for b in buf.iter_mut() {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            *b = if round % 3 == 0 { (x % 24) as u8 } else { x as u8 };
+        }
+    }
+
+    /// Runs `many` (n inputs in, n 32-byte results out) against the scalar
+    /// function `one` on a few hundred inputs.
+    fn check_haraka_batch(one: HarakaFn, many: HarakaFn, in_len: usize, n: usize) {
+        let mut inp = [0u8; 8 * 64];
+        let mut out = [0u8; 8 * 32];
+        let mut want = [0u8; 32];
+        for round in 0..300 {
+            haraka_input(round, &mut inp[..n * in_len]);
+            unsafe { many(out.as_mut_ptr(), inp.as_ptr()) };
+            for s in 0..n {
+                unsafe { one(want.as_mut_ptr(), inp[s * in_len..].as_ptr()) };
+                assert_eq!(out[s * 32..s * 32 + 32], want, "round {} state {}", round, s);
+            }
+        }
+    }
+
+    #[test]
+    fn haraka_x4_matches_portable() {
+        let many: [HarakaFn; 3] = [haraka512_port_x4, haraka512_port_zero_x4, haraka256_port_x4];
+        for ((one, len), many) in HARAKA_SCALAR.into_iter().zip(many) {
+            check_haraka_batch(one, many, len, 4);
+        }
+    }
+
+    #[test]
+    fn haraka_bs8_matches_portable() {
+        let many: [HarakaFn; 3] = [haraka512_port_bs8, haraka512_port_zero_bs8, haraka256_port_bs8];
+        for ((one, len), many) in HARAKA_SCALAR.into_iter().zip(many) {
+            check_haraka_batch(one, many, len, 8);
+        }
+    }
+
+    #[test]
+    #[cfg(any(target_arch = "x86_64", target_arch = "x86"))]
+    fn haraka_vperm_matches_portable() {
+        if std::is_x86_feature_detected!("ssse3") {
+            let one: [HarakaFn; 3] = [haraka512_vperm, haraka512_vperm_zero, haraka256_vperm];
+            for ((port, len), vperm) in HARAKA_SCALAR.into_iter().zip(one) {
+                check_haraka_batch(port, vperm, len, 1);
+            }
+        }
+        if std::is_x86_feature_detected!("avx2") {
+            let two: [HarakaFn; 3] = [haraka512_vperm_x2, haraka512_vperm_zero_x2, haraka256_vperm_x2];
+            for ((port, len), vperm) in HARAKA_SCALAR.into_iter().zip(two) {
+                check_haraka_batch(port, vperm, len, 2);
+            }
+        }
+    }
+
+    #[test]
+    #[cfg(any(target_arch = "x86_64", target_arch = "x86"))]
+    fn haraka_gather_matches_portable() {
+        if std::is_x86_feature_detected!("avx2") {
+            let eight: [HarakaFn; 3] = [haraka512_gather_x8, haraka512_gather_zero_x8, haraka256_gather_x8];
+            for ((port, len), gather) in HARAKA_SCALAR.into_iter().zip(eight) {
+                check_haraka_batch(port, gather, len, 8);
+            }
+        }
+    }
+
+    #[test]
+    #[cfg(any(target_arch = "x86_64", target_arch = "x86"))]
+    fn clmul_pclmul_matches_bit_serial() {
+        // Low 64 bits of the carry-less product, one bit at a time.
+        fn reference(a: u64, b: u64) -> u64 {
+            (0..64).filter(|i| (b >> i) & 1 == 1).fold(0, |r, i| r ^ (a << i))
+        }
+        if !std::is_x86_feature_detected!("pclmulqdq") {
+            return;
+        }
+        let mut x = 0x9E37_79B9_7F4A_7C15u64;
+        for round in 0..10_000u64 {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            let (a, b) = (x, x.rotate_left(29) ^ round);
+            let want = reference(a, b);
+            assert_eq!(unsafe { clmul_mix_pclmul(a, b) }, want, "{:#x} * {:#x}", a, b);
+        }
+    }
+
+    // dispatched_engines_match_portable is in tests/dispatch.rs: it switches
+    // the engine level, so it runs in its own process.
+
+    #[test]
+    fn midstate_matches_full_hash() {
+        let mut data = [0u8; 200];
+        haraka_input(2, &mut data);
+        for len in [0usize, 1, 31, 32, 33, 56, 64, 65, 96, 140, 200] {
+            for pre in (0..=len).step_by(32) {
+                let msg = &data[..len];
+                let v1 = VerusMidstate::v1(&msg[..pre]).unwrap();
+                let v2 = VerusMidstate::v2(&msg[..pre]).unwrap();
+                assert_eq!(v1.finish(&msg[pre..]), verus_hash_v1(msg), "v1 len {} prefix {}", len, pre);
+                assert_eq!(v2.finish(&msg[pre..]), verus_hash_v2(msg), "v2 len {} prefix {}", len, pre);
+
+                // Round trip through bytes, then absorb one more block
+                let mut back = VerusMidstate::from_bytes(&v2.to_bytes()).unwrap();
+                if len - pre >= 32 {
+                    assert!(back.absorb(&msg[pre..pre + 32]));
+                    assert_eq!(back.finish(&msg[pre + 32..]), verus_hash_v2(msg));
+                }
+            }
+        }
+        assert!(VerusMidstate::v2(&data[..31]).is_none());
+        let mut bad = VerusMidstate::v1(&[]).unwrap().to_bytes();
+        bad[0] = 7;
+        assert!(VerusMidstate::from_bytes(&bad).is_none());
+    }
+
+    #[test]
+    fn verushash1_batch_matches_single() {
+        // Unequal lengths, including empty messages and exact block multiples,
+        // so slots finish and refill at different times.
+        const LENS: [usize; 11] = [0, 1, 31, 32, 33, 64, 100, 0, 140, 7, 257];
+        let mut data = [0u8; 300];
+        haraka_input(1, &mut data);
+        for n in 0..=LENS.len() {
+            let ptrs: std::vec::Vec<*const u8> =
+                (0..n).map(|i| data[i..].as_ptr()).collect();
+            let mut out = std::vec![0u8; 32 * n];
+            unsafe { verus_hash_v1_batch(out.as_mut_ptr(), ptrs.as_ptr(), LENS.as_ptr(), n) };
+            for i in 0..n {
+                let want = verus_hash_v1(&data[i..i + LENS[i]]);
+                assert_eq!(out[32 * i..32 * i + 32], want, "n {} message {}", n, i);
+            }
+        }
+    }
+
+    #[test]
+    fn hash_batch_matches_single() {
+        let mut data = [0u8; 9 * 140 + 5];
+        haraka_input(3, &mut data);
+        for stride in [1usize, 31, 32, 33, 64, 100, 140] {
+            let n = data.len() / stride;
+            let v2 = hash_batch(&data, stride);
+            let v1 = hash_batch_v1(&data, stride);
+            assert_eq!(v2.len(), n);
+            for (i, msg) in data.chunks_exact(stride).enumerate() {
+                assert_eq!(v2[i], verus_hash_v2(msg), "v2 stride {} message {}", stride, i);
+                assert_eq!(v1[i], verus_hash_v1(msg), "v1 stride {} message {}", stride, i);
+            }
+
+            // Partial groups of four take the single-message path
+            let mut out = [[0u8; 32]; 7];
+            let k = n.min(7);
+            hash_batch_into(&data, stride, &mut out[..k]);
+            assert_eq!(out[..k], v2[..k]);
+            hash_batch_v1_into(&data, stride, &mut out[..k]);
+            assert_eq!(out[..k], v1[..k]);
+        }
+        assert!(hash_batch(&data[..10], 64).is_empty());
+    }
+
+    #[test]
+    fn search_matches_linear_scan() {
+        let mut template = [0u8; 140];
+        haraka_input(4, &mut template);
+        let mut target = [0xffu8; 32];
+        target[0] = 0x0f; // about one nonce in 16
+
+        for (len, offset) in [(64usize, 56usize), (64, 0), (64, 28), (40, 30), (140, 100)] {
+            let tmpl = &template[..len];
+            let mut want = std::vec::Vec::new();
+            let mut msg = tmpl.to_vec();
+            for nonce in 3u64..203 {
+                msg[offset..offset + 8].copy_from_slice(&nonce.to_le_bytes());
+                let mut be = verus_hash_v2(&msg);
+                be.reverse();
+                if be <= target {
+                    want.push(nonce);
+                }
+            }
+            let got: std::vec::Vec<u64> = search_v2(tmpl, offset, 3..203, &target).collect();
+            assert_eq!(got, want, "len {} offset {}", len, offset);
+        }
+        assert_eq!(search_v2(&template[..64], 56, 0..1000, &[0u8; 32]).next(), None);
+        assert_eq!(search_v2(&template[..64], 56, 9..9, &[0xffu8; 32]).next(), None);
+        assert_eq!(search_v2(&template[..64], 56, 9..10, &[0xffu8; 32]).next(), Some(9));
+    }
+
+    #[test]
+    fn hasher_matches_one_shot() {
+        let mut data = [0u8; 300];
+        haraka_input(5, &mut data);
+        for len in [0usize, 1, 31, 32, 33, 63, 64, 65, 100, 140, 300] {
+            let msg = &data[..len];
+            for piece in [1usize, 7, 31, 32, 45, 300] {
+                let mut v1 = VerusHasher::v1();
+                let mut v2 = VerusHasher::v2();
+                for chunk in msg.chunks(piece) {
+                    v1.update(chunk);
+                    v2.update(chunk);
+                }
+                assert_eq!(v1.finalize(), verus_hash_v1(msg), "v1 len {} piece {}", len, piece);
+                assert_eq!(v2.finalize(), verus_hash_v2(msg), "v2 len {} piece {}", len, piece);
+            }
+        }
+
+        let mut w = VerusHasher::v2();
+        std::io::copy(&mut &data[..], &mut w).unwrap();
+        assert_eq!(w.finalize(), verus_hash_v2(&data));
+        w.update(&[]);
+        assert_eq!(w.finalize(), verus_hash_v2(&data));
+    }
+
+    #[test]
+    fn verushash2b_matches_upstream() {
+        // CVerusHashV2(SOLUTION_VERUSHHASH_V2_2) Write + Finalize2b of
+        // origin-impl over bytes 0, 1, 2, ...; 80 twice for the cached key.
+        let data: Vec<u8> = (0..1487).map(|i| i as u8).collect();
+        let cases: [(usize, [u8; 32]); 6] = [
+            (32, hex_literal::hex!("966784e114a4182ec8a38aeee6ec770bb627fa73eeee3281265ccf5dede9547f")),
+            (80, hex_literal::hex!("b670b52b5d8afbbe5418a2e1a6465f58f1ccf6a9d3a167fb888c956505d2d3a7")),
+            (80, hex_literal::hex!("b670b52b5d8afbbe5418a2e1a6465f58f1ccf6a9d3a167fb888c956505d2d3a7")),
+            (140, hex_literal::hex!("d960dd4676157a3337767b741b2013f11e4507f6c0f7a98f52532955246a793a")),
+            (1487, hex_literal::hex!("9eae5c2931e7d3689e1ca5669f50ac8063a5189dcd9f2873ff036ec97f62952a")),
+            (31, hex_literal::hex!("af55ecf86229d0254dce5bf3e8678b9862c7c67a007a6438a4ef9084a4c375dd")),
+        ];
+        for (len, want) in cases {
+            assert_eq!(verus_hash_v2b(&data[..len]), want, "len {}", len);
+        }
+    }
+
+    #[test]
+    fn verus_hash_v2_pinned() {
+        // The v2.2 sponge feeds forward only the 32 bytes Haraka-512 writes.
+        // Values from the code before the midstate rework, with its
+        // uninitialised feed-forward buffer zeroed, over bytes 1, 8, 15, ...
+        let data: Vec<u8> = (0..1487).map(|i| (i * 7 + 1) as u8).collect();
+        let cases: [(usize, [u8; 32]); 10] = [
+            (0, hex_literal::hex!("1ac2d9f33e884cfa1d750cb440ba056be50edfb5425d223fbeda75821e793f9d")),
+            (1, hex_literal::hex!("929fe0146a8b01e09528355314b948716d53e652165e6f2536874c654a7a7287")),
+            (31, hex_literal::hex!("0786efdd5eae807900313a9a209cc9e8f999255e9ccc5e15c9fd1ff93018b327")),
+            (32, hex_literal::hex!("cf00f342835a96a7c8b72605fd68df3620d0e5fe1373a7f91a31806e1f0150e5")),
+            (33, hex_literal::hex!("01ba086034dfee80060ddd274aeda711ee6a1edca4f6dfded48b7b4ca88428c2")),
+            (63, hex_literal::hex!("c2c3a2154edd1bafc574775230ef523e2ca0180c4063ba785db1ed0cfca1fdf4")),
+            (64, hex_literal::hex!("2e3d1d4515f1aaca298ac8026bc3e35bb1917b634904e42fda79a1ce99bcc636")),
+            (80, hex_literal::hex!("87555e45a0d6623380e28b02dee42ba218f93863fc232cd65932fedb229c0e36")),
+            (140, hex_literal::hex!("539b941ba0440208542c415cde764b992cd712dddc916ccd3743782b0e32f116")),
+            (1487, hex_literal::hex!("a6f18f0aa6d022f3a1465a4dd8e26b62b9dd69acfa256c1613566fd464da0e36")),
+        ];
+        for (len, want) in cases {
+            assert_eq!(verus_hash_v2(&data[..len]), want, "len {}", len);
+        }
+    }
+
+    #[test]
+    fn hash_context_matches_thread_key() {
+        let data: Vec<u8> = (0..1487).map(|i| (i * 7 + 3) as u8).collect();
+        let mut ctx = VerusHashContext::new().expect("context");
+        // moved to another thread and reused across seeds and lengths
+        let ctx = std::thread::spawn(move || {
+            for len in [80, 80, 140, 32, 1487, 81, 80, 0, 31] {
+                assert_eq!(ctx.hash(&data[..len]), verus_hash_v2b(&data[..len]), "len {}", len);
+            }
+            ctx
+        })
+        .join()
+        .unwrap();
+        drop(ctx);
+    }
+
+    // Under 32 bytes the seed is all zero. A context that has never made a key must still
+    // derive one for it, not hash with the empty key space. The value is from
+    // origin-impl's Finalize2b, on a fresh context and on a fresh thread.
+    #[test]
+    fn hash_context_short_message_first() {
+        let data: [u8; 10] = core::array::from_fn(|i| i as u8 + 1);
+        let want = hex_literal::hex!("6d87d2c511da51df0b83cf84eed966ef2af8d30125ed449e393e13b05d3d2709");
+        let mut ctx = VerusHashContext::new().expect("context");
+        assert_eq!(ctx.hash(&data), want);
+        let thread = std::thread::spawn(move || verus_hash_v2b(&data)).join().unwrap();
+        assert_eq!(thread, want);
+    }
+
     // Removed generate_constants_file test.
     // Constants are now generated automatically by the build.rs script.
 
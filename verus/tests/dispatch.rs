@@ -0,0 +1,42 @@
+//! Engine level switching of the C library (`c/haraka_dispatch.h`).
+//!
+//! ForceCPUHarakaOptimized() changes the engines for the whole process,
+//! so this lives in its own test binary: no other test hashes while the
+//! level is pinned, and only this one test runs in it.
+
+#![cfg(any(target_arch = "x86_64", target_arch = "x86"))]
+
+use verus::{verus_hash_v1, verus_hash_v2, verus_hash_v2b};
+
+extern "C" {
+    fn IsCPUHarakaOptimized() -> i32;
+    fn ForceCPUHarakaOptimized(level: i32);
+}
+
+#[test]
+fn dispatched_engines_match_portable() {
+    // Every engine level the CPU offers must give the portable hashes.
+    let cpu = unsafe { IsCPUHarakaOptimized() };
+    let mut data = [0u8; 200];
+    let mut x = 0x9E37_79B9_7F4A_7C15u64;
+    for b in data.iter_mut() {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        *b = x as u8;
+    }
+    let mut want = Vec::new();
+    for level in 0..=cpu {
+        unsafe { ForceCPUHarakaOptimized(level) };
+        for (round, len) in [0usize, 1, 31, 32, 33, 64, 80, 140, 200].into_iter().enumerate() {
+            let msg = &data[..len];
+            let got = (verus_hash_v1(msg), verus_hash_v2(msg), verus_hash_v2b(msg));
+            if level == 0 {
+                want.push(got);
+            } else {
+                assert_eq!(got, want[round], "level {} len {}", level, len);
+            }
+        }
+    }
+    unsafe { ForceCPUHarakaOptimized(-1) };
+}